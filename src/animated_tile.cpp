@@ -16,21 +16,35 @@
 #include "viewport_func.h"
 #include "framerate_type.h"
 
+#include <unordered_map>
+
 #include "safeguards.h"
 
-/** The table/list with animated tiles. */
+/**
+ * The table/list with animated tiles. Deleted tiles leave an #INVALID_TILE
+ * hole that is removed by CompactAnimatedTiles(), so the order of the other
+ * tiles never changes and removing a tile does not need to move any others.
+ */
 SmallVector<TileIndex, 256> _animated_tiles;
 
+/** Position of every animated tile in #_animated_tiles. */
+static std::unordered_map<TileIndex, uint> _animated_tile_index;
+
+/** Number of holes in #_animated_tiles. */
+static uint _animated_tile_holes = 0;
+
 /**
  * Removes the given tile from the animated tile table.
  * @param tile the tile to remove
  */
 void DeleteAnimatedTile(TileIndex tile)
 {
-	TileIndex *to_remove = _animated_tiles.Find(tile);
-	if (to_remove != _animated_tiles.End()) {
+	std::unordered_map<TileIndex, uint>::iterator it = _animated_tile_index.find(tile);
+	if (it != _animated_tile_index.end()) {
 		/* The order of the remaining elements must stay the same, otherwise the animation loop may miss a tile. */
-		_animated_tiles.ErasePreservingOrder(to_remove);
+		_animated_tiles[it->second] = INVALID_TILE;
+		_animated_tile_index.erase(it);
+		_animated_tile_holes++;
 		MarkTileDirtyByTile(tile);
 	}
 }
@@ -43,7 +57,48 @@ void DeleteAnimatedTile(TileIndex tile)
 void AddAnimatedTile(TileIndex tile)
 {
 	MarkTileDirtyByTile(tile);
-	_animated_tiles.Include(tile);
+	if (_animated_tile_index.insert(std::make_pair(tile, _animated_tiles.Length())).second) {
+		*_animated_tiles.Append() = tile;
+	}
+}
+
+/**
+ * Remove the holes left by DeleteAnimatedTile() from the animated tile
+ * table, keeping the order of the remaining tiles.
+ */
+void CompactAnimatedTiles()
+{
+	if (_animated_tile_holes == 0) return;
+
+	uint count = 0;
+	for (uint i = 0; i < _animated_tiles.Length(); i++) {
+		TileIndex tile = _animated_tiles[i];
+		if (tile == INVALID_TILE) continue;
+
+		if (count != i) {
+			_animated_tiles[count] = tile;
+			_animated_tile_index[tile] = count;
+		}
+		count++;
+	}
+
+	_animated_tiles.Resize(count);
+	_animated_tile_holes = 0;
+}
+
+/**
+ * Rebuild the position lookup of the animated tile table after it has
+ * been filled directly, i.e. when loading a savegame.
+ */
+void RebuildAnimatedTileIndex()
+{
+	_animated_tile_index.clear();
+	_animated_tile_holes = 0;
+
+	for (uint i = 0; i < _animated_tiles.Length(); i++) {
+		/* Only the first one of duplicates from old savegames is found, like with a linear search. */
+		_animated_tile_index.insert(std::make_pair(_animated_tiles[i], i));
+	}
 }
 
 /**
@@ -53,21 +108,14 @@ void AnimateAnimatedTiles()
 {
 	PerformanceAccumulator framerate(PFE_GL_LANDSCAPE);
 
-	const TileIndex *ti = _animated_tiles.Begin();
-	while (ti < _animated_tiles.End()) {
-		const TileIndex curr = *ti;
-		AnimateTile(curr);
-		/* During the AnimateTile call, DeleteAnimatedTile could have been called,
-		 * deleting an element we've already processed and pushing the rest one
-		 * slot to the left. We can detect this by checking whether the index
-		 * in the current slot has changed - if it has, an element has been deleted,
-		 * and we should process the current slot again instead of going forward.
-		 * NOTE: this will still break if more than one animated tile is being
-		 *       deleted during the same AnimateTile call, but no code seems to
-		 *       be doing this anyway.
-		 */
-		if (*ti == curr) ++ti;
+	/* Tiles may be added or deleted during the AnimateTile call. Added tiles are
+	 * appended and animated in this loop too; deleted tiles just leave a hole. */
+	for (uint i = 0; i < _animated_tiles.Length(); i++) {
+		const TileIndex curr = _animated_tiles[i];
+		if (curr != INVALID_TILE) AnimateTile(curr);
 	}
+
+	CompactAnimatedTiles();
 }
 
 /**
@@ -76,4 +124,6 @@ void AnimateAnimatedTiles()
 void InitializeAnimatedTiles()
 {
 	_animated_tiles.Clear();
+	_animated_tile_index.clear();
+	_animated_tile_holes = 0;
 }
@@ -0,0 +1,137 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file 32bpp_anim_avx2.cpp Implementation of the AVX2 32 bpp blitter with animation support. */
+
+#ifdef WITH_SSE
+
+#include "../stdafx.h"
+#include "../video/video_driver.hpp"
+#include "../table/sprites.h"
+#include "32bpp_anim_avx2.hpp"
+#include "32bpp_sse_func.hpp"
+
+#include "../safeguards.h"
+
+/** Instantiation of the AVX2 32bpp blitter factory. */
+static FBlitter_32bppAVX2_Anim iFBlitter_32bppAVX2_Anim;
+
+/**
+ * Get which of 8 pixels are not fully transparent, as a mask of 8 uint16 for the animation buffer.
+ * @param src The pixels.
+ * @param alpha_mask Mask of the alpha channel of each pixel.
+ * @return 0xFFFF for each fully transparent pixel, 0 for the others.
+ */
+static inline __m128i TransparentAnimMask(__m256i src, const __m256i &alpha_mask)
+{
+	__m256i transparent = _mm256_cmpeq_epi32(_mm256_and_si256(src, alpha_mask), _mm256_setzero_si256());
+	transparent = _mm256_packs_epi32(transparent, transparent); // Packs within the lanes: pixels 0-3 in quad 0, 4-7 in quad 2.
+	return _mm256_castsi256_si128(_mm256_permute4x64_epi64(transparent, 0x08));
+}
+
+/**
+ * Draws a sprite in BM_TRANSPARENT mode; gives the same result as the SSE4 blitter.
+ *
+ * @param bp further blitting parameters
+ * @param zoom zoom level at which we are drawing
+ */
+void Blitter_32bppAVX2_Anim::DrawTransparent(const Blitter::BlitterParams *bp, ZoomLevel zoom)
+{
+	Colour *dst_line = (Colour *) bp->dst + bp->top * bp->pitch + bp->left;
+	uint16 *anim_line = this->anim_buf + this->ScreenToAnimOffset((uint32 *)bp->dst) + bp->top * this->anim_buf_pitch + bp->left;
+
+	/* Find where to start reading in the source sprite. */
+	const Blitter_32bppSSE_Base::SpriteData * const sd = (const Blitter_32bppSSE_Base::SpriteData *) bp->sprite;
+	const SpriteInfo * const si = &sd->infos[zoom];
+	const Colour *src_rgba_line = (const Colour *) ((const byte *) &sd->data[si->sprite_offset] + bp->skip_top * si->sprite_line_size) + bp->skip_left;
+
+	/* Load these variables into register before loop. */
+	const __m128i a_cm          = ALPHA_CONTROL_MASK;
+	const __m128i tr_nom_base   = TRANSPARENT_NOM_BASE;
+	const __m256i a_cm_8        = _mm256_broadcastsi128_si256(ALPHA_CONTROL_MASK);
+	const __m256i tr_nom_base_8 = _mm256_broadcastsi128_si256(TRANSPARENT_NOM_BASE);
+	const __m256i alpha_mask_8  = _mm256_set1_epi32(0xFF000000);
+
+	for (int y = bp->height; y != 0; y--) {
+		Colour *dst = dst_line;
+		const Colour *src = src_rgba_line + META_LENGTH;
+		uint16 *anim = anim_line;
+
+		/* Make the current colour a bit more black, so it looks like this image is transparent. */
+		for (uint x = (uint) bp->width / 8; x > 0; x--) {
+			__m256i srcABCD = _mm256_loadu_si256((const __m256i*) src);
+			__m256i dstABCD = _mm256_loadu_si256((__m256i*) dst);
+			_mm256_storeu_si256((__m256i*) dst, DarkenEightPixels(srcABCD, dstABCD, a_cm_8, tr_nom_base_8));
+			__m128i anim8 = _mm_loadu_si128((__m128i*) anim);
+			_mm_storeu_si128((__m128i*) anim, _mm_and_si128(anim8, TransparentAnimMask(srcABCD, alpha_mask_8)));
+			src += 8;
+			dst += 8;
+			anim += 8;
+		}
+
+		for (uint x = (uint) bp->width % 8; x > 0; x--) {
+			__m128i srcABCD = _mm_cvtsi32_si128(src->data);
+			__m128i dstABCD = _mm_cvtsi32_si128(dst->data);
+			dst->data = _mm_cvtsi128_si32(DarkenTwoPixels(srcABCD, dstABCD, a_cm, tr_nom_base));
+			if (src->a) *anim = 0;
+			src++;
+			dst++;
+			anim++;
+		}
+
+		src_rgba_line = (const Colour*) ((const byte*) src_rgba_line + si->sprite_line_size);
+		dst_line += bp->pitch;
+		anim_line += this->anim_buf_pitch;
+	}
+}
+
+/**
+ * Draws a sprite to a (screen) buffer. Uses the SSE4 blitter for the modes without an AVX2 variant.
+ *
+ * @param bp further blitting parameters
+ * @param mode blitter mode
+ * @param zoom zoom level at which we are drawing
+ */
+void Blitter_32bppAVX2_Anim::Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom)
+{
+	if (mode == BM_TRANSPARENT) {
+		this->DrawTransparent(bp, zoom);
+	} else {
+		Blitter_32bppSSE4_Anim::Draw(bp, mode, zoom);
+	}
+}
+
+void Blitter_32bppAVX2_Anim::DrawColourMappingRect(void *dst, int width, int height, PaletteID pal)
+{
+	if (_screen_disable_anim || pal != PALETTE_TO_TRANSPARENT) {
+		Blitter_32bppSSE4_Anim::DrawColourMappingRect(dst, width, height, pal);
+		return;
+	}
+
+	const __m256i nom = _mm256_set1_epi16(154);
+	const __m256i alpha_mask = _mm256_set1_epi32(0xFF000000);
+	Colour *udst = (Colour *)dst;
+	uint16 *anim = this->anim_buf + this->ScreenToAnimOffset((uint32 *)dst);
+	do {
+		int i = 0;
+		for (; i + 8 <= width; i += 8) {
+			__m256i dstABCD = _mm256_loadu_si256((__m256i*) (udst + i));
+			_mm256_storeu_si256((__m256i*) (udst + i), MakeEightPixelsTransparent(dstABCD, nom, alpha_mask));
+			_mm_storeu_si128((__m128i*) (anim + i), _mm_setzero_si128());
+		}
+		for (; i != width; i++) {
+			udst[i] = MakeTransparent(udst[i], 154);
+			anim[i] = 0;
+		}
+		udst += _screen.pitch;
+		anim += this->anim_buf_pitch;
+	} while (--height);
+}
+
+#endif /* WITH_SSE */
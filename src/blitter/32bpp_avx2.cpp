@@ -0,0 +1,49 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file 32bpp_avx2.cpp Implementation of the AVX2 32 bpp blitter. */
+
+#ifdef WITH_SSE
+
+#include "../stdafx.h"
+#include "../zoom_func.h"
+#include "../settings_type.h"
+#include "../table/sprites.h"
+#include "32bpp_avx2.hpp"
+#include "32bpp_sse_func.hpp"
+
+#include "../safeguards.h"
+
+/** Instantiation of the AVX2 32bpp blitter factory. */
+static FBlitter_32bppAVX2 iFBlitter_32bppAVX2;
+
+void Blitter_32bppAVX2::DrawColourMappingRect(void *dst, int width, int height, PaletteID pal)
+{
+	if (pal != PALETTE_TO_TRANSPARENT) {
+		Blitter_32bppSSE4::DrawColourMappingRect(dst, width, height, pal);
+		return;
+	}
+
+	const __m256i nom = _mm256_set1_epi16(154);
+	const __m256i alpha_mask = _mm256_set1_epi32(0xFF000000);
+	Colour *udst = (Colour *)dst;
+	do {
+		int i = 0;
+		for (; i + 8 <= width; i += 8) {
+			__m256i dstABCD = _mm256_loadu_si256((__m256i*) (udst + i));
+			_mm256_storeu_si256((__m256i*) (udst + i), MakeEightPixelsTransparent(dstABCD, nom, alpha_mask));
+		}
+		for (; i != width; i++) {
+			udst[i] = MakeTransparent(udst[i], 154);
+		}
+		udst += _screen.pitch;
+	} while (--height);
+}
+
+#endif /* WITH_SSE */
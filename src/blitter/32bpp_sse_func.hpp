@@ -100,6 +100,69 @@ static inline __m128i DarkenTwoPixels(__m128i src, __m128i dst, const __m128i &d
 	return _mm_packus_epi16(dstAB, dstAB);
 }
 
+#if (SSE_VERSION >= 5)
+/* Alpha blend 4 pixels that have been expanded to 16 bits per channel. */
+static inline __m256i AlphaBlendFourExpandedPixels(__m256i src, __m256i dst, const __m256i &distribution_mask)
+{
+	__m256i alpha = _mm256_cmpgt_epi16(src, _mm256_setzero_si256()); // if (alpha > 0) a++;
+	alpha = _mm256_srli_epi16(alpha, 15);
+	alpha = _mm256_add_epi16(alpha, src);
+	alpha = _mm256_shuffle_epi8(alpha, distribution_mask);
+
+	src = _mm256_sub_epi16(src, dst);    //    (r - Cr)
+	src = _mm256_mullo_epi16(src, alpha); //  a*(r - Cr)
+	src = _mm256_srli_epi16(src, 8);     //  a*(r - Cr)/256
+	return _mm256_add_epi16(src, dst);   //  a*(r - Cr)/256 + Cr
+}
+
+/* Alpha blend 8 pixels, giving the same result as AlphaBlendTwoPixels for each pair.
+ * The unpacking and packing work within the 128 bits lanes, so the pixels end up in their original order.
+ */
+static inline __m256i AlphaBlendEightPixels(__m256i src, __m256i dst, const __m256i &distribution_mask, const __m256i &pack_low_mask, const __m256i &pack_high_mask)
+{
+	__m256i srcLo = _mm256_unpacklo_epi8(src, _mm256_setzero_si256()); // pixels 0, 1, 4 and 5
+	__m256i dstLo = _mm256_unpacklo_epi8(dst, _mm256_setzero_si256());
+	__m256i srcHi = _mm256_unpackhi_epi8(src, _mm256_setzero_si256()); // pixels 2, 3, 6 and 7
+	__m256i dstHi = _mm256_unpackhi_epi8(dst, _mm256_setzero_si256());
+
+	srcLo = _mm256_shuffle_epi8(AlphaBlendFourExpandedPixels(srcLo, dstLo, distribution_mask), pack_low_mask);
+	srcHi = _mm256_shuffle_epi8(AlphaBlendFourExpandedPixels(srcHi, dstHi, distribution_mask), pack_high_mask);
+	return _mm256_or_si256(srcLo, srcHi);
+}
+
+/* Darken 8 pixels, giving the same result as DarkenTwoPixels for each pair. */
+static inline __m256i DarkenEightPixels(__m256i src, __m256i dst, const __m256i &distribution_mask, const __m256i &tr_nom_base)
+{
+	__m256i srcLo = _mm256_unpacklo_epi8(src, _mm256_setzero_si256());
+	__m256i dstLo = _mm256_unpacklo_epi8(dst, _mm256_setzero_si256());
+	__m256i srcHi = _mm256_unpackhi_epi8(src, _mm256_setzero_si256());
+	__m256i dstHi = _mm256_unpackhi_epi8(dst, _mm256_setzero_si256());
+
+	__m256i nomLo = _mm256_sub_epi16(tr_nom_base, _mm256_srli_epi16(_mm256_shuffle_epi8(srcLo, distribution_mask), 2));
+	__m256i nomHi = _mm256_sub_epi16(tr_nom_base, _mm256_srli_epi16(_mm256_shuffle_epi8(srcHi, distribution_mask), 2));
+	dstLo = _mm256_srli_epi16(_mm256_mullo_epi16(dstLo, nomLo), 8);
+	dstHi = _mm256_srli_epi16(_mm256_mullo_epi16(dstHi, nomHi), 8);
+	return _mm256_packus_epi16(dstLo, dstHi);
+}
+
+/* Copy the pixels of 8 that are not fully transparent, for sprites without semi-transparent pixels. */
+static inline __m256i CopyEightOpaquePixels(__m256i src, __m256i dst, const __m256i &alpha_mask)
+{
+	__m256i transparent = _mm256_cmpeq_epi32(_mm256_and_si256(src, alpha_mask), _mm256_setzero_si256());
+	return _mm256_blendv_epi8(src, dst, transparent);
+}
+
+/* Make 8 pixels transparent the way Blitter_32bppBase::MakeTransparent does, i.e. an opaque colour with rgb * nom / 256. */
+static inline __m256i MakeEightPixelsTransparent(__m256i dst, const __m256i &nom, const __m256i &alpha_mask)
+{
+	__m256i dstLo = _mm256_unpacklo_epi8(dst, _mm256_setzero_si256());
+	__m256i dstHi = _mm256_unpackhi_epi8(dst, _mm256_setzero_si256());
+	dstLo = _mm256_srli_epi16(_mm256_mullo_epi16(dstLo, nom), 8);
+	dstHi = _mm256_srli_epi16(_mm256_mullo_epi16(dstHi, nom), 8);
+	return _mm256_or_si256(_mm256_packus_epi16(dstLo, dstHi), alpha_mask);
+}
+#endif /* SSE_VERSION >= 5 */
+
 IGNORE_UNINITIALIZED_WARNING_START
 static Colour ReallyAdjustBrightness(Colour colour, uint8 brightness)
 {
@@ -200,6 +263,8 @@ inline void Blitter_32bppSSE2::Draw(const Blitter::BlitterParams *bp, ZoomLevel
 inline void Blitter_32bppSSSE3::Draw(const Blitter::BlitterParams *bp, ZoomLevel zoom)
 #elif (SSE_VERSION == 4)
 inline void Blitter_32bppSSE4::Draw(const Blitter::BlitterParams *bp, ZoomLevel zoom)
+#elif (SSE_VERSION == 5)
+inline void Blitter_32bppAVX2::Draw(const Blitter::BlitterParams *bp, ZoomLevel zoom)
 #endif
 {
 	const byte * const remap = bp->remap;
@@ -234,6 +299,14 @@ inline void Blitter_32bppSSE4::Draw(const Blitter::BlitterParams *bp, ZoomLevel
 	#define DARKEN_PARAM_2      tr_nom_base
 #endif
 	const __m128i tr_nom_base = TRANSPARENT_NOM_BASE;
+#if (SSE_VERSION >= 5)
+	const __m256i a_cm_8         = _mm256_broadcastsi128_si256(ALPHA_CONTROL_MASK);
+	const __m256i pack_low_cm_8  = _mm256_broadcastsi128_si256(PACK_LOW_CONTROL_MASK);
+	const __m256i pack_high_cm_8 = _mm256_broadcastsi128_si256(PACK_HIGH_CONTROL_MASK);
+	const __m256i tr_nom_base_8  = _mm256_broadcastsi128_si256(TRANSPARENT_NOM_BASE);
+	const __m256i alpha_mask_8   = _mm256_set1_epi32(0xFF000000);
+	const __m128i m_mask_8       = _mm_set1_epi16(0x00FF);
+#endif
 
 	for (int y = bp->height; y != 0; y--) {
 		Colour *dst = dst_line;
@@ -256,7 +329,18 @@ inline void Blitter_32bppSSE4::Draw(const Blitter::BlitterParams *bp, ZoomLevel
 		switch (mode) {
 			default:
 				if (!translucent) {
+#if (SSE_VERSION >= 5)
+					for (uint x = (uint) effective_width / 8; x > 0; x--) {
+						__m256i srcABCD = _mm256_loadu_si256((const __m256i*) src);
+						__m256i dstABCD = _mm256_loadu_si256((__m256i*) dst);
+						_mm256_storeu_si256((__m256i*) dst, CopyEightOpaquePixels(srcABCD, dstABCD, alpha_mask_8));
+						src += 8;
+						dst += 8;
+					}
+					for (uint x = (uint) effective_width % 8; x > 0; x--) {
+#else
 					for (uint x = (uint) effective_width; x > 0; x--) {
+#endif
 						if (src->a) *dst = *src;
 						src++;
 						dst++;
@@ -264,7 +348,19 @@ inline void Blitter_32bppSSE4::Draw(const Blitter::BlitterParams *bp, ZoomLevel
 					break;
 				}
 
+#if (SSE_VERSION >= 5)
+				for (uint x = (uint) effective_width / 8; x > 0; x--) {
+					__m256i srcABCD = _mm256_loadu_si256((const __m256i*) src);
+					__m256i dstABCD = _mm256_loadu_si256((__m256i*) dst);
+					_mm256_storeu_si256((__m256i*) dst, AlphaBlendEightPixels(srcABCD, dstABCD, a_cm_8, pack_low_cm_8, pack_high_cm_8));
+					src += 8;
+					dst += 8;
+				}
+
+				for (uint x = ((uint) effective_width % 8) / 2; x > 0; x--) {
+#else
 				for (uint x = (uint) effective_width / 2; x > 0; x--) {
+#endif
 					__m128i srcABCD = _mm_loadl_epi64((const __m128i*) src);
 					__m128i dstABCD = _mm_loadl_epi64((__m128i*) dst);
 					_mm_storel_epi64((__m128i*) dst, AlphaBlendTwoPixels(srcABCD, dstABCD, ALPHA_BLEND_PARAM_1, ALPHA_BLEND_PARAM_2));
@@ -282,6 +378,19 @@ inline void Blitter_32bppSSE4::Draw(const Blitter::BlitterParams *bp, ZoomLevel
 			case BM_COLOUR_REMAP:
 #if (SSE_VERSION >= 3)
 				for (uint x = (uint) effective_width / 2; x > 0; x--) {
+#if (SSE_VERSION >= 5)
+					/* Blend 8 pixels at once when none of them has to be remapped. */
+					if (x >= 4 && _mm_testz_si128(_mm_loadu_si128((const __m128i*) src_mv), m_mask_8)) {
+						__m256i srcABCD = _mm256_loadu_si256((const __m256i*) src);
+						__m256i dstABCD = _mm256_loadu_si256((__m256i*) dst);
+						_mm256_storeu_si256((__m256i*) dst, AlphaBlendEightPixels(srcABCD, dstABCD, a_cm_8, pack_low_cm_8, pack_high_cm_8));
+						dst += 8;
+						src += 8;
+						src_mv += 8;
+						x -= 3;
+						continue;
+					}
+#endif
 					__m128i srcABCD = _mm_loadl_epi64((const __m128i*) src);
 					__m128i dstABCD = _mm_loadl_epi64((__m128i*) dst);
 					uint32 mvX2 = *((uint32 *) const_cast<MapValue *>(src_mv));
@@ -363,7 +472,19 @@ bmcr_alpha_blend_single:
 
 			case BM_TRANSPARENT:
 				/* Make the current colour a bit more black, so it looks like this image is transparent. */
+#if (SSE_VERSION >= 5)
+				for (uint x = (uint) bp->width / 8; x > 0; x--) {
+					__m256i srcABCD = _mm256_loadu_si256((const __m256i*) src);
+					__m256i dstABCD = _mm256_loadu_si256((__m256i*) dst);
+					_mm256_storeu_si256((__m256i*) dst, DarkenEightPixels(srcABCD, dstABCD, a_cm_8, tr_nom_base_8));
+					src += 8;
+					dst += 8;
+				}
+
+				for (uint x = ((uint) bp->width % 8) / 2; x > 0; x--) {
+#else
 				for (uint x = (uint) bp->width / 2; x > 0; x--) {
+#endif
 					__m128i srcABCD = _mm_loadl_epi64((const __m128i*) src);
 					__m128i dstABCD = _mm_loadl_epi64((__m128i*) dst);
 					_mm_storel_epi64((__m128i *) dst, DarkenTwoPixels(srcABCD, dstABCD, DARKEN_PARAM_1, DARKEN_PARAM_2));
@@ -428,6 +549,8 @@ void Blitter_32bppSSE2::Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomL
 void Blitter_32bppSSSE3::Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom)
 #elif (SSE_VERSION == 4)
 void Blitter_32bppSSE4::Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom)
+#elif (SSE_VERSION == 5)
+void Blitter_32bppAVX2::Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom)
 #endif
 {
 	switch (mode) {
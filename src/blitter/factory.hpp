@@ -16,6 +16,7 @@
 #include "../debug.h"
 #include "../string_func.h"
 #include "../core/string_compare_type.hpp"
+#include "../core/smallvec_type.hpp"
 #include <map>
 
 #if defined(WITH_COCOA)
@@ -149,6 +150,18 @@ public:
 		return *GetActiveBlitter();
 	}
 
+	/**
+	 * Create an instance of every usable blitter, e.g. to compare them.
+	 * @param blitters The list to add the blitters to; the caller has to delete them.
+	 */
+	static void CreateAllInstances(SmallVector<Blitter *, 16> &blitters)
+	{
+		Blitters::iterator it = GetBlitters().begin();
+		for (; it != GetBlitters().end(); it++) {
+			*blitters.Append() = (*it).second->CreateInstance();
+		}
+	}
+
 	/**
 	 * Fill a buffer with information about the blitters.
 	 * @param p The buffer to fill.
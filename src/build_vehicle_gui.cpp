@@ -97,6 +97,104 @@ bool _engine_sort_last_order[]          = {false, false, false, false}; ///< Las
 bool _engine_sort_show_hidden_engines[] = {false, false, false, false}; ///< Last set 'show hidden engines' setting for each vehicle type.
 static CargoID _engine_sort_last_cargo_criteria[] = {CF_ANY, CF_ANY, CF_ANY, CF_ANY}; ///< Last set filter criteria, for each vehicle type.
 
+/** Function computing a property of an engine to sort or filter on. */
+typedef int64 EngineKeyFunction(const Engine *e);
+
+/**
+ * Per-engine cache of a property to sort or filter on.
+ * Many of these properties are subject to NewGRF callbacks, which are too
+ * expensive to run for every comparison while sorting. The cached value is
+ * recomputed when asked for with another function or on another day.
+ */
+class EngineKeyCache {
+	/** Cached property of a single engine. */
+	struct Entry {
+		EngineKeyFunction *func; ///< Function the value was computed with, or \c NULL if there is no value.
+		Date date;               ///< Date the value was computed at.
+		int64 value;             ///< The cached value.
+	};
+
+	SmallVector<Entry, 256> entries; ///< Cached values, indexed by EngineID.
+
+public:
+	/**
+	 * Get the property of an engine, computing it if it is not cached.
+	 * @param engine The engine.
+	 * @param func Function computing the property.
+	 * @return The value of the property.
+	 */
+	int64 Get(EngineID engine, EngineKeyFunction *func)
+	{
+		while (this->entries.Length() <= engine) this->entries.Append()->func = NULL;
+
+		Entry &entry = this->entries[engine];
+		if (entry.func != func || entry.date != _date) {
+			entry.func = func;
+			entry.date = _date;
+			entry.value = func(Engine::Get(engine));
+		}
+		return entry.value;
+	}
+
+	/** Forget all cached values. */
+	void Clear()
+	{
+		this->entries.Clear();
+	}
+};
+
+static EngineKeyCache _engine_sort_keys;   ///< Cached properties the engine lists are sorted on.
+static EngineKeyCache _engine_filter_keys; ///< Cached properties the engine lists are filtered on.
+
+/**
+ * Forget the cached properties engine lists are sorted and filtered on.
+ * Needed when the engines or their properties may have changed, other than by the passing of days.
+ */
+void InvalidateEngineSortKeys()
+{
+	_engine_sort_keys.Clear();
+	_engine_filter_keys.Clear();
+}
+
+/* Properties of engines that may need NewGRF callbacks, for use with #EngineKeyCache. */
+static int64 GetEngineCost(const Engine *e) { return e->GetCost(); }
+static int64 GetEngineSpeed(const Engine *e) { return e->GetDisplayMaxSpeed(); }
+static int64 GetEnginePower(const Engine *e) { return e->GetPower(); }
+static int64 GetEngineTractiveEffort(const Engine *e) { return e->GetDisplayMaxTractiveEffort(); }
+static int64 GetEngineRunningCost(const Engine *e) { return e->GetRunningCost(); }
+static int64 GetEngineRange(const Engine *e) { return e->GetRange(); }
+static int64 GetEngineArticulatedCapacity(const Engine *e) { return GetTotalCapacityOfArticulatedParts(e->index); }
+static int64 GetEngineRefitMask(const Engine *e) { return (int64)GetUnionOfArticulatedRefitMasks(e->index, true); }
+
+/** Running cost per unit of power; for sorting on power versus running cost. */
+static int64 GetEngineRunningCostPerPower(const Engine *e)
+{
+	/* Here we are using a few tricks to get the right sort.
+	 * We want power/running cost, but since we usually got higher running cost than power and we store the result in an int,
+	 * we will actually calculate cunning cost/power (to make it more than 1).
+	 * Because of this, the sorter has to reverse the order as well.
+	 * Another thing is that both power and running costs should be doubled for multiheaded engines.
+	 * Since it would be multiplying with 2 in both numerator and denominator, it will even themselves out and we skip checking for multiheaded. */
+	return e->GetRunningCost() / max(1U, (uint)e->GetPower());
+}
+
+/** Capacity of a train engine, counting both heads of multiheaded engines. */
+static int64 GetTrainEngineCapacity(const Engine *e)
+{
+	return GetTotalCapacityOfArticulatedParts(e->index) * (e->u.rail.railveh_type == RAILVEH_MULTIHEAD ? 2 : 1);
+}
+
+/** Passenger capacity of an aircraft in the high bits, mail capacity in the low 16 bits. */
+static int64 GetAircraftCapacities(const Engine *e)
+{
+	uint16 mail;
+	int64 capacity = e->GetDisplayDefaultCapacity(&mail);
+	return capacity << 16 | mail;
+}
+
+/** Default capacity of a ship. */
+static int64 GetShipCapacity(const Engine *e) { return e->GetDisplayDefaultCapacity(); }
+
 /**
  * Determines order of engines by engineID
  * @param *a first engine to compare
@@ -185,8 +283,8 @@ static int CDECL EngineReliabilitySorter(const EngineID *a, const EngineID *b)
  */
 static int CDECL EngineCostSorter(const EngineID *a, const EngineID *b)
 {
-	Money va = Engine::Get(*a)->GetCost();
-	Money vb = Engine::Get(*b)->GetCost();
+	int64 va = _engine_sort_keys.Get(*a, &GetEngineCost);
+	int64 vb = _engine_sort_keys.Get(*b, &GetEngineCost);
 	int r = ClampToI32(va - vb);
 
 	/* Use EngineID to sort instead since we want consistent sorting */
@@ -202,8 +300,8 @@ static int CDECL EngineCostSorter(const EngineID *a, const EngineID *b)
  */
 static int CDECL EngineSpeedSorter(const EngineID *a, const EngineID *b)
 {
-	int va = Engine::Get(*a)->GetDisplayMaxSpeed();
-	int vb = Engine::Get(*b)->GetDisplayMaxSpeed();
+	int va = (int)_engine_sort_keys.Get(*a, &GetEngineSpeed);
+	int vb = (int)_engine_sort_keys.Get(*b, &GetEngineSpeed);
 	int r = va - vb;
 
 	/* Use EngineID to sort instead since we want consistent sorting */
@@ -219,8 +317,8 @@ static int CDECL EngineSpeedSorter(const EngineID *a, const EngineID *b)
  */
 static int CDECL EnginePowerSorter(const EngineID *a, const EngineID *b)
 {
-	int va = Engine::Get(*a)->GetPower();
-	int vb = Engine::Get(*b)->GetPower();
+	int va = (int)_engine_sort_keys.Get(*a, &GetEnginePower);
+	int vb = (int)_engine_sort_keys.Get(*b, &GetEnginePower);
 	int r = va - vb;
 
 	/* Use EngineID to sort instead since we want consistent sorting */
@@ -236,8 +334,8 @@ static int CDECL EnginePowerSorter(const EngineID *a, const EngineID *b)
  */
 static int CDECL EngineTractiveEffortSorter(const EngineID *a, const EngineID *b)
 {
-	int va = Engine::Get(*a)->GetDisplayMaxTractiveEffort();
-	int vb = Engine::Get(*b)->GetDisplayMaxTractiveEffort();
+	int va = (int)_engine_sort_keys.Get(*a, &GetEngineTractiveEffort);
+	int vb = (int)_engine_sort_keys.Get(*b, &GetEngineTractiveEffort);
 	int r = va - vb;
 
 	/* Use EngineID to sort instead since we want consistent sorting */
@@ -253,8 +351,8 @@ static int CDECL EngineTractiveEffortSorter(const EngineID *a, const EngineID *b
  */
 static int CDECL EngineRunningCostSorter(const EngineID *a, const EngineID *b)
 {
-	Money va = Engine::Get(*a)->GetRunningCost();
-	Money vb = Engine::Get(*b)->GetRunningCost();
+	int64 va = _engine_sort_keys.Get(*a, &GetEngineRunningCost);
+	int64 vb = _engine_sort_keys.Get(*b, &GetEngineRunningCost);
 	int r = ClampToI32(va - vb);
 
 	/* Use EngineID to sort instead since we want consistent sorting */
@@ -270,17 +368,9 @@ static int CDECL EngineRunningCostSorter(const EngineID *a, const EngineID *b)
  */
 static int CDECL EnginePowerVsRunningCostSorter(const EngineID *a, const EngineID *b)
 {
-	const Engine *e_a = Engine::Get(*a);
-	const Engine *e_b = Engine::Get(*b);
-
-	/* Here we are using a few tricks to get the right sort.
-	 * We want power/running cost, but since we usually got higher running cost than power and we store the result in an int,
-	 * we will actually calculate cunning cost/power (to make it more than 1).
-	 * Because of this, the return value have to be reversed as well and we return b - a instead of a - b.
-	 * Another thing is that both power and running costs should be doubled for multiheaded engines.
-	 * Since it would be multiplying with 2 in both numerator and denominator, it will even themselves out and we skip checking for multiheaded. */
-	Money va = (e_a->GetRunningCost()) / max(1U, (uint)e_a->GetPower());
-	Money vb = (e_b->GetRunningCost()) / max(1U, (uint)e_b->GetPower());
+	/* We get running cost/power, so we return b - a instead of a - b. */
+	int64 va = _engine_sort_keys.Get(*a, &GetEngineRunningCostPerPower);
+	int64 vb = _engine_sort_keys.Get(*b, &GetEngineRunningCostPerPower);
 	int r = ClampToI32(vb - va);
 
 	/* Use EngineID to sort instead since we want consistent sorting */
@@ -298,11 +388,8 @@ static int CDECL EnginePowerVsRunningCostSorter(const EngineID *a, const EngineI
  */
 static int CDECL TrainEngineCapacitySorter(const EngineID *a, const EngineID *b)
 {
-	const RailVehicleInfo *rvi_a = RailVehInfo(*a);
-	const RailVehicleInfo *rvi_b = RailVehInfo(*b);
-
-	int va = GetTotalCapacityOfArticulatedParts(*a) * (rvi_a->railveh_type == RAILVEH_MULTIHEAD ? 2 : 1);
-	int vb = GetTotalCapacityOfArticulatedParts(*b) * (rvi_b->railveh_type == RAILVEH_MULTIHEAD ? 2 : 1);
+	int va = (int)_engine_sort_keys.Get(*a, &GetTrainEngineCapacity);
+	int vb = (int)_engine_sort_keys.Get(*b, &GetTrainEngineCapacity);
 	int r = va - vb;
 
 	/* Use EngineID to sort instead since we want consistent sorting */
@@ -337,8 +424,8 @@ static int CDECL TrainEnginesThenWagonsSorter(const EngineID *a, const EngineID
  */
 static int CDECL RoadVehEngineCapacitySorter(const EngineID *a, const EngineID *b)
 {
-	int va = GetTotalCapacityOfArticulatedParts(*a);
-	int vb = GetTotalCapacityOfArticulatedParts(*b);
+	int va = (int)_engine_sort_keys.Get(*a, &GetEngineArticulatedCapacity);
+	int vb = (int)_engine_sort_keys.Get(*b, &GetEngineArticulatedCapacity);
 	int r = va - vb;
 
 	/* Use EngineID to sort instead since we want consistent sorting */
@@ -356,11 +443,8 @@ static int CDECL RoadVehEngineCapacitySorter(const EngineID *a, const EngineID *
  */
 static int CDECL ShipEngineCapacitySorter(const EngineID *a, const EngineID *b)
 {
-	const Engine *e_a = Engine::Get(*a);
-	const Engine *e_b = Engine::Get(*b);
-
-	int va = e_a->GetDisplayDefaultCapacity();
-	int vb = e_b->GetDisplayDefaultCapacity();
+	int va = (int)_engine_sort_keys.Get(*a, &GetShipCapacity);
+	int vb = (int)_engine_sort_keys.Get(*b, &GetShipCapacity);
 	int r = va - vb;
 
 	/* Use EngineID to sort instead since we want consistent sorting */
@@ -378,12 +462,13 @@ static int CDECL ShipEngineCapacitySorter(const EngineID *a, const EngineID *b)
  */
 static int CDECL AircraftEngineCargoSorter(const EngineID *a, const EngineID *b)
 {
-	const Engine *e_a = Engine::Get(*a);
-	const Engine *e_b = Engine::Get(*b);
+	int64 capacities_a = _engine_sort_keys.Get(*a, &GetAircraftCapacities);
+	int64 capacities_b = _engine_sort_keys.Get(*b, &GetAircraftCapacities);
 
-	uint16 mail_a, mail_b;
-	int va = e_a->GetDisplayDefaultCapacity(&mail_a);
-	int vb = e_b->GetDisplayDefaultCapacity(&mail_b);
+	uint16 mail_a = GB(capacities_a, 0, 16);
+	uint16 mail_b = GB(capacities_b, 0, 16);
+	int va = (int)(capacities_a >> 16);
+	int vb = (int)(capacities_b >> 16);
 	int r = va - vb;
 
 	if (r == 0) {
@@ -406,8 +491,8 @@ static int CDECL AircraftEngineCargoSorter(const EngineID *a, const EngineID *b)
  */
 static int CDECL AircraftRangeSorter(const EngineID *a, const EngineID *b)
 {
-	uint16 r_a = Engine::Get(*a)->GetRange();
-	uint16 r_b = Engine::Get(*b)->GetRange();
+	uint16 r_a = (uint16)_engine_sort_keys.Get(*a, &GetEngineRange);
+	uint16 r_b = (uint16)_engine_sort_keys.Get(*b, &GetEngineRange);
 
 	int r = r_a - r_b;
 
@@ -524,7 +609,7 @@ const StringID _engine_sort_listing[][12] = {{
 static bool CDECL CargoFilter(const EngineID *eid, const CargoID cid)
 {
 	if (cid == CF_ANY) return true;
-	CargoTypes refit_mask = GetUnionOfArticulatedRefitMasks(*eid, true) & _standard_cargo_mask;
+	CargoTypes refit_mask = (CargoTypes)_engine_filter_keys.Get(*eid, &GetEngineRefitMask) & _standard_cargo_mask;
 	return (cid == CF_NONE ? refit_mask == 0 : HasBit(refit_mask, cid));
 }
 
@@ -1355,6 +1440,8 @@ struct BuildVehicleWindow : Window {
 			this->sort_criteria = 0;
 			_engine_sort_last_criteria[VEH_ROAD] = 0;
 		}
+		/* Engines may have become available or their properties changed, e.g. by changing settings. */
+		InvalidateEngineSortKeys();
 		this->eng_list.ForceRebuild();
 	}
 
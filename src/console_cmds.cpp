@@ -35,9 +35,12 @@
 #include "ai/ai.hpp"
 #include "ai/ai_config.hpp"
 #include "newgrf.h"
+#include "newgrf_debug.h"
+#include "newgrf_profiling.h"
 #include "console_func.h"
 #include "engine_base.h"
 #include "game/game.hpp"
+#include "gfxinit.h"
 #include "table/strings.h"
 
 #include "safeguards.h"
@@ -1352,10 +1355,12 @@ DEF_CONSOLE_CMD(ConAlias)
 DEF_CONSOLE_CMD(ConScreenShot)
 {
 	if (argc == 0) {
-		IConsoleHelp("Create a screenshot of the game. Usage: 'screenshot [big | giant | no_con] [file name]'");
+		IConsoleHelp("Create a screenshot of the game. Usage: 'screenshot [big | giant | minimap | no_con] [file name]'");
 		IConsoleHelp("'big' makes a zoomed-in screenshot of the visible area, 'giant' makes a screenshot of the "
-				"whole map, 'no_con' hides the console to create the screenshot. 'big' or 'giant' "
+				"whole map, 'minimap' makes a top down map of the whole map with one pixel per tile, "
+				"'no_con' hides the console to create the screenshot. 'big' or 'giant' "
 				"screenshots are always drawn without console");
+		IConsoleHelp("Only 'minimap' is available on dedicated servers");
 		return true;
 	}
 
@@ -1373,6 +1378,10 @@ DEF_CONSOLE_CMD(ConScreenShot)
 			/* screenshot giant [filename] */
 			type = SC_WORLD;
 			if (argc > 2) name = argv[2];
+		} else if (strcmp(argv[1], "minimap") == 0) {
+			/* screenshot minimap [filename] */
+			type = SC_MINIMAP;
+			if (argc > 2) name = argv[2];
 		} else if (strcmp(argv[1], "no_con") == 0) {
 			/* screenshot no_con [filename] */
 			IConsoleClose();
@@ -1390,6 +1399,23 @@ DEF_CONSOLE_CMD(ConScreenShot)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConBenchmarkBlitters)
+{
+	if (argc == 0) {
+		IConsoleHelp("Measure how fast each usable blitter draws the base graphics sprites and rectangles. Usage: 'benchmark_blitters [<rounds>]'");
+		IConsoleHelp("All sprites are drawn <rounds> times, default 10, per blitter, drawing mode and zoom level into an off-screen buffer");
+		return true;
+	}
+
+	if (argc > 2) return false;
+
+	uint32 rounds = 10;
+	if (argc == 2 && (!GetArgumentInteger(&rounds, argv[1]) || rounds == 0)) return false;
+
+	BenchmarkBlitters(rounds);
+	return true;
+}
+
 DEF_CONSOLE_CMD(ConInfoCmd)
 {
 	if (argc == 0) {
@@ -1908,6 +1934,22 @@ DEF_CONSOLE_CMD(ConFramerate)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConDirtyStats)
+{
+	extern void ConPrintDirtyBlockStats(bool reset); // gfx.cpp
+
+	if (argc == 0) {
+		IConsoleHelp("Show how much of the screen was marked dirty and redrawn. Usage: 'dirty_stats [reset]'");
+		IConsoleHelp("Compare the marked and redrawn pixels to see how much overdraw marking areas dirty causes; 'reset' starts counting anew");
+		return true;
+	}
+
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "reset") != 0)) return false;
+
+	ConPrintDirtyBlockStats(argc == 2);
+	return true;
+}
+
 DEF_CONSOLE_CMD(ConFramerateWindow)
 {
 	extern void ShowFramerateWindow();
@@ -1926,6 +1968,59 @@ DEF_CONSOLE_CMD(ConFramerateWindow)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConNewGRFProfile)
+{
+	extern void ConPrintNewGRFProfile(); // newgrf_profiling.cpp
+
+	if (argc == 0) {
+		IConsoleHelp("Measure the time NewGRFs take to resolve sprites and callbacks. Usage: 'newgrf_profile [start | stop | reset | export <file>]'");
+		IConsoleHelp("Without arguments the measurements are shown per NewGRF, feature and callback; 'export' writes them to a CSV file");
+		return true;
+	}
+
+	if (argc == 1) {
+		ConPrintNewGRFProfile();
+		return true;
+	}
+
+	if (argc == 2 && strcmp(argv[1], "start") == 0) {
+		StartNewGRFProfiling();
+		IConsolePrint(CC_DEFAULT, "NewGRF profiling started");
+	} else if (argc == 2 && strcmp(argv[1], "stop") == 0) {
+		StopNewGRFProfiling();
+		IConsolePrint(CC_DEFAULT, "NewGRF profiling stopped");
+	} else if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+		ResetNewGRFProfile();
+	} else if (argc == 3 && strcmp(argv[1], "export") == 0) {
+		if (!ExportNewGRFProfile(argv[2])) {
+			IConsolePrintF(CC_ERROR, "Could not write '%s'", argv[2]);
+			return true;
+		}
+		IConsolePrintF(CC_DEFAULT, "NewGRF profile written to '%s'", argv[2]);
+	} else {
+		return false;
+	}
+
+	InvalidateWindowData(WC_NEWGRF_PROFILE, 0);
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConNewGRFProfileWindow)
+{
+	if (argc == 0) {
+		IConsoleHelp("Open the NewGRF profile window");
+		return true;
+	}
+
+	if (_network_dedicated) {
+		IConsoleError("Can not open NewGRF profile window on a dedicated server");
+		return false;
+	}
+
+	ShowNewGRFProfileWindow();
+	return true;
+}
+
 /*******************************
  * console command registration
  *******************************/
@@ -1951,6 +2046,7 @@ void IConsoleStdLibRegister()
 	IConsoleCmdRegister("reset_enginepool", ConResetEnginePool, ConHookNoNetwork);
 	IConsoleCmdRegister("return",       ConReturn);
 	IConsoleCmdRegister("screenshot",   ConScreenShot);
+	IConsoleCmdRegister("benchmark_blitters", ConBenchmarkBlitters);
 	IConsoleCmdRegister("script",       ConScript);
 	IConsoleCmdRegister("scrollto",     ConScrollToTile);
 	IConsoleCmdRegister("alias",        ConAlias);
@@ -2057,7 +2153,10 @@ void IConsoleStdLibRegister()
 	IConsoleDebugLibRegister();
 #endif
 	IConsoleCmdRegister("fps",     ConFramerate);
+	IConsoleCmdRegister("dirty_stats", ConDirtyStats);
 	IConsoleCmdRegister("fps_wnd", ConFramerateWindow);
+	IConsoleCmdRegister("newgrf_profile",     ConNewGRFProfile);
+	IConsoleCmdRegister("newgrf_profile_wnd", ConNewGRFProfileWindow);
 
 	/* NewGRF development stuff */
 	IConsoleCmdRegister("reload_newgrfs",  ConNewGRFReload, ConHookNewGRFDeveloperTool);
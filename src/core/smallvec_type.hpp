@@ -114,6 +114,18 @@ public:
 		data = NULL;
 	}
 
+	/**
+	 * Exchange the contents of this list with another list without copying
+	 * any items; pointers to the items stay valid.
+	 * @param other The list to swap with.
+	 */
+	inline void Swap(SmallVector &other)
+	{
+		::Swap(this->data, other.data);
+		::Swap(this->items, other.items);
+		::Swap(this->capacity, other.capacity);
+	}
+
 	/**
 	 * Compact the list down to the smallest block size boundary.
 	 */
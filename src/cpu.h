@@ -21,7 +21,7 @@ uint64 ottd_rdtsc();
 /**
  * Get the CPUID information from the CPU.
  * @param info The retrieved info. All zeros on architectures without CPUID.
- * @param type The information this instruction should retrieve.
+ * @param type The information this instruction should retrieve; sub-leaf 0 is used for types that have sub-leafs.
  */
 void ottd_cpuid(int info[4], int type);
 
@@ -34,4 +34,11 @@ void ottd_cpuid(int info[4], int type);
  */
 bool HasCPUIDFlag(uint type, uint index, uint bit);
 
+/**
+ * Check whether AVX2 instructions can be used, i.e. whether both the CPU
+ * and the operating system support them.
+ * @return True iff AVX2 can be used.
+ */
+bool HasCPUAVX2Support();
+
 #endif /* CPU_H */
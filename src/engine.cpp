@@ -71,7 +71,8 @@ const uint EngineOverrideManager::NUM_DEFAULT_ENGINES = _engine_counts[VEH_TRAIN
 Engine::Engine() :
 	name(NULL),
 	overrides_count(0),
-	overrides(NULL)
+	overrides(NULL),
+	callback_32day_result(CALLBACK_UNKNOWN)
 {
 }
 
@@ -81,6 +82,7 @@ Engine::Engine(VehicleType type, EngineID base)
 	this->grf_prop.local_id = base;
 	this->list_position = base;
 	this->preview_company = INVALID_COMPANY;
+	this->callback_32day_result = CALLBACK_UNKNOWN;
 
 	/* Check if this base engine is within the original engine data range */
 	if (base >= _engine_counts[type]) {
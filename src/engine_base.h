@@ -61,6 +61,7 @@ struct Engine : EnginePool::PoolItem<&_engine_pool> {
 	uint16 overrides_count;
 	struct WagonOverride *overrides;
 	uint16 list_position;
+	uint32 callback_32day_result; ///< Result of #CBID_VEHICLE_32DAY_CALLBACK when it is the same for all vehicles, #CALLBACK_VARIES or #CALLBACK_UNKNOWN.
 
 	Engine();
 	Engine(VehicleType type, EngineID base);
@@ -32,6 +32,12 @@
 #include "basedir.h"
 #endif
 
+#if !defined(WIN32) && !defined(LIMITED_FDS) && defined(_POSIX_MAPPED_FILES) && _POSIX_MAPPED_FILES > 0
+/** Slotted files are read through a memory mapping instead of stdio. */
+#	define WITH_FIO_MMAP
+#	include <sys/mman.h>
+#endif
+
 #include "safeguards.h"
 
 /** Size of the #Fio data buffer. */
@@ -51,6 +57,12 @@ struct Fio {
 	uint open_handles;                     ///< current amount of open handles
 	uint usage_count[MAX_FILE_SLOTS];      ///< count how many times this file has been opened
 #endif /* LIMITED_FDS */
+#if defined(WITH_FIO_MMAP)
+	byte *cur_mapping;                     ///< memory mapping of the current file, or NULL when it is read with stdio
+	size_t cur_mapping_size;               ///< size of the current memory mapping
+	byte *mappings[MAX_FILE_SLOTS];        ///< memory mapping of each whole file, or NULL when it is read with stdio
+	size_t mapping_sizes[MAX_FILE_SLOTS];  ///< size of each memory mapping
+#endif /* WITH_FIO_MMAP */
 };
 
 static Fio _fio; ///< #Fio instance.
@@ -88,6 +100,15 @@ const char *FioGetFilename(uint8 slot)
 void FioSeekTo(size_t pos, int mode)
 {
 	if (mode == SEEK_CUR) pos += FioGetPos();
+#if defined(WITH_FIO_MMAP)
+	if (_fio.cur_mapping != NULL) {
+		/* The whole mapping acts as the buffer, so it never needs to be refilled. */
+		_fio.buffer = _fio.cur_mapping + min(pos, _fio.cur_mapping_size);
+		_fio.buffer_end = _fio.cur_mapping + _fio.cur_mapping_size;
+		_fio.pos = _fio.cur_mapping_size;
+		return;
+	}
+#endif /* WITH_FIO_MMAP */
 	_fio.buffer = _fio.buffer_end = _fio.buffer_start + FIO_BUFFER_SIZE;
 	_fio.pos = pos;
 	if (fseek(_fio.cur_fh, _fio.pos, SEEK_SET) < 0) {
@@ -123,6 +144,10 @@ void FioSeekToFile(uint8 slot, size_t pos)
 	assert(f != NULL);
 	_fio.cur_fh = f;
 	_fio.filename = _fio.filenames[slot];
+#if defined(WITH_FIO_MMAP)
+	_fio.cur_mapping = _fio.mappings[slot];
+	_fio.cur_mapping_size = _fio.mapping_sizes[slot];
+#endif /* WITH_FIO_MMAP */
 	FioSeekTo(pos, SEEK_SET);
 }
 
@@ -133,6 +158,10 @@ void FioSeekToFile(uint8 slot, size_t pos)
 byte FioReadByte()
 {
 	if (_fio.buffer == _fio.buffer_end) {
+#if defined(WITH_FIO_MMAP)
+		/* Reached the end of a mapped file. */
+		if (_fio.cur_mapping != NULL) return 0;
+#endif /* WITH_FIO_MMAP */
 		_fio.buffer = _fio.buffer_start;
 		size_t size = fread(_fio.buffer, 1, FIO_BUFFER_SIZE, _fio.cur_fh);
 		_fio.pos += size;
@@ -183,11 +212,30 @@ uint32 FioReadDword()
  * Read a block.
  * @param ptr Destination buffer.
  * @param size Number of bytes to read.
+ * @note Bytes past the end of the file are read as zero, just like #FioReadByte does.
  */
 void FioReadBlock(void *ptr, size_t size)
 {
-	FioSeekTo(FioGetPos(), SEEK_SET);
-	_fio.pos += fread(ptr, 1, size, _fio.cur_fh);
+	byte *dest = (byte *)ptr;
+
+	/* First take what is still in the buffer (or the mapping). */
+	size_t buffered = min<size_t>(_fio.buffer_end - _fio.buffer, size);
+	MemCpyT(dest, _fio.buffer, buffered);
+	_fio.buffer += buffered;
+	dest += buffered;
+	size -= buffered;
+	if (size == 0) return;
+
+	size_t read = 0;
+#if defined(WITH_FIO_MMAP)
+	if (_fio.cur_mapping == NULL)
+#endif /* WITH_FIO_MMAP */
+	{
+		/* The buffer is exhausted, so the file is positioned right after it. */
+		read = fread(dest, 1, size, _fio.cur_fh);
+		_fio.pos += read;
+	}
+	MemSetT(dest + read, 0, size - read);
 }
 
 /**
@@ -198,6 +246,13 @@ static inline void FioCloseFile(int slot)
 {
 	if (_fio.handles[slot] != NULL) {
 		fclose(_fio.handles[slot]);
+#if defined(WITH_FIO_MMAP)
+		if (_fio.mappings[slot] != NULL) {
+			if (_fio.cur_mapping == _fio.mappings[slot]) _fio.cur_mapping = NULL;
+			munmap(_fio.mappings[slot], _fio.mapping_sizes[slot]);
+			_fio.mappings[slot] = NULL;
+		}
+#endif /* WITH_FIO_MMAP */
 
 		free(_fio.shortnames[slot]);
 		_fio.shortnames[slot] = NULL;
@@ -263,6 +318,19 @@ void FioOpenFile(int slot, const char *filename, Subdirectory subdir)
 	_fio.handles[slot] = f;
 	_fio.filenames[slot] = filename;
 
+#if defined(WITH_FIO_MMAP)
+	/* Map the whole file; positions in slots are absolute, even for files within a tar.
+	 * When mapping fails the file is simply read with stdio. */
+	struct stat st;
+	if (fstat(fileno(f), &st) == 0 && st.st_size > 0 && (uint64)st.st_size <= SIZE_MAX) {
+		void *mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+		if (mapping != MAP_FAILED) {
+			_fio.mappings[slot] = (byte *)mapping;
+			_fio.mapping_sizes[slot] = st.st_size;
+		}
+	}
+#endif /* WITH_FIO_MMAP */
+
 	/* Store the filename without path and extension */
 	const char *t = strrchr(filename, PATHSEPCHAR);
 	_fio.shortnames[slot] = stredup(t == NULL ? filename : t);
@@ -1224,6 +1292,8 @@ void DeterminePaths(const char *exe)
 	_highscore_file = str_fmt("%shs.dat", config_dir);
 	extern char *_hotkeys_file;
 	_hotkeys_file = str_fmt("%shotkeys.cfg", config_dir);
+	extern char *_grf_md5_cache_file;
+	_grf_md5_cache_file = str_fmt("%snewgrf_md5.dat", config_dir);
 	extern char *_windows_file;
 	_windows_file = str_fmt("%swindows.cfg", config_dir);
 
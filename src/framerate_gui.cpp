@@ -18,6 +18,7 @@
 #include "debug.h"
 #include "console_func.h"
 #include "console_type.h"
+#include "spritecache.h"
 
 #include "widgets/framerate_widget.h"
 
@@ -175,7 +176,7 @@ namespace {
  * The basis of the timestamp is implementation defined, but the value should be steady,
  * so differences can be taken to reliably measure intervals.
  */
-static TimingMeasurement GetPerformanceTimer()
+TimingMeasurement GetPerformanceTimer()
 {
 	using namespace std::chrono;
 	return (TimingMeasurement)time_point_cast<microseconds>(high_resolution_clock::now()).time_since_epoch().count();
@@ -257,6 +258,7 @@ static const NWidgetPart _framerate_window_widgets[] = {
 				NWidget(WWT_EMPTY, COLOUR_GREY, WID_FRW_TIMES_AVERAGE),
 			EndContainer(),
 			NWidget(WWT_TEXT, COLOUR_GREY, WID_FRW_INFO_DATA_POINTS), SetDataTip(STR_FRAMERATE_DATA_POINTS, 0x0),
+			NWidget(WWT_TEXT, COLOUR_GREY, WID_FRW_INFO_SPRITE_CACHE), SetDataTip(STR_FRAMERATE_SPRITE_CACHE, STR_FRAMERATE_SPRITE_CACHE_TOOLTIP),
 		EndContainer(),
 	EndContainer(),
 };
@@ -365,6 +367,11 @@ struct FramerateWindow : Window {
 			case WID_FRW_INFO_DATA_POINTS:
 				SetDParam(0, NUM_FRAMERATE_POINTS);
 				break;
+			case WID_FRW_INFO_SPRITE_CACHE:
+				SetDParam(0, _sprite_cache_stats.hits);
+				SetDParam(1, _sprite_cache_stats.misses);
+				SetDParam(2, _sprite_cache_stats.evictions);
+				break;
 		}
 	}
 
@@ -388,6 +395,12 @@ struct FramerateWindow : Window {
 				SetDParam(1, 2);
 				*size = GetStringBoundingBox(STR_FRAMERATE_SPEED_FACTOR);
 				break;
+			case WID_FRW_INFO_SPRITE_CACHE:
+				SetDParamMaxDigits(0, 10);
+				SetDParamMaxDigits(1, 8);
+				SetDParamMaxDigits(2, 8);
+				*size = GetStringBoundingBox(STR_FRAMERATE_SPRITE_CACHE);
+				break;
 
 			case WID_FRW_TIMES_NAMES: {
 				int linecount = PFE_MAX - PFE_FIRST;
@@ -820,4 +833,7 @@ void ConPrintFramerate()
 	if (!printed_anything) {
 		IConsoleWarning("No performance measurements have been taken yet");
 	}
+
+	IConsolePrintF(TC_SILVER, "Sprite cache: " OTTD_PRINTF64 " hits, " OTTD_PRINTF64 " misses, " OTTD_PRINTF64 " evictions",
+		(int64)_sprite_cache_stats.hits, (int64)_sprite_cache_stats.misses, (int64)_sprite_cache_stats.evictions);
 }
@@ -33,6 +33,8 @@ DECLARE_POSTFIX_INCREMENT(PerformanceElement)
 
 typedef uint64 TimingMeasurement;
 
+TimingMeasurement GetPerformanceTimer();
+
 /**
  * RAII class for measuring simple elements of performance.
  * Construct an object with the appropriate element parameter when processing begins,
@@ -298,6 +298,17 @@ void HandleGeneratingWorldAbortion()
 void GenerateWorld(GenWorldMode mode, uint size_x, uint size_y, bool reset_settings)
 {
 	if (HasModalProgress()) return;
+
+	/* The map size can come from the configuration file, which does not know
+	 * about the limit on the number of tiles. Shrink the longest side. */
+	while (FindFirstBit(size_x) + FindFirstBit(size_y) > MAX_MAP_TILES_BITS) {
+		if (size_x > size_y) {
+			size_x >>= 1;
+		} else {
+			size_y >>= 1;
+		}
+	}
+
 	_gw.mode   = mode;
 	_gw.size_x = size_x;
 	_gw.size_y = size_y;
@@ -21,6 +21,8 @@
 #include "network/network_func.h"
 #include "window_func.h"
 #include "newgrf_debug.h"
+#include "viewport_func.h"
+#include "console_func.h"
 
 #include "table/palettes.h"
 #include "table/string_colours.h"
@@ -77,6 +79,25 @@ static uint _dirty_bytes_per_line = 0;
 static byte *_dirty_blocks = NULL;
 extern uint _dirty_block_colour;
 
+/** Columns of a line of dirty blocks that may contain dirty blocks. */
+struct DirtyBlockSpan {
+	uint left;  ///< First column that may be dirty.
+	uint right; ///< One past the last column that may be dirty, or \c 0 when the line is clean.
+};
+
+static DirtyBlockSpan *_dirty_block_spans = NULL; ///< Per line of dirty blocks the columns that may be dirty.
+
+/** Statistics about marking parts of the screen dirty and redrawing them. */
+struct DirtyBlockStats {
+	uint64 frames;         ///< Number of calls to #DrawDirtyBlocks that redrew anything.
+	uint64 marked_areas;   ///< Number of areas marked dirty.
+	uint64 marked_pixels;  ///< Total size of the areas marked dirty; overlapping areas are counted multiple times.
+	uint64 redrawn_rects;  ///< Number of rectangles redrawn.
+	uint64 redrawn_pixels; ///< Total size of the rectangles redrawn.
+};
+
+static DirtyBlockStats _dirty_block_stats; ///< Statistics about the dirty blocks since the last reset.
+
 void GfxScroll(int left, int top, int width, int height, int xo, int yo)
 {
 	Blitter *blitter = BlitterFactory::GetCurrentBlitter();
@@ -1189,8 +1210,12 @@ void GetBroadestDigit(uint *front, uint *next, FontSize size)
 
 void ScreenSizeChanged()
 {
+	uint lines = CeilDiv(_screen.height, DIRTY_BLOCK_HEIGHT);
 	_dirty_bytes_per_line = CeilDiv(_screen.width, DIRTY_BLOCK_WIDTH);
-	_dirty_blocks = ReallocT<byte>(_dirty_blocks, _dirty_bytes_per_line * CeilDiv(_screen.height, DIRTY_BLOCK_HEIGHT));
+	_dirty_blocks = ReallocT<byte>(_dirty_blocks, _dirty_bytes_per_line * lines);
+	_dirty_block_spans = ReallocT<DirtyBlockSpan>(_dirty_block_spans, lines);
+	MemSetT(_dirty_blocks, 0, _dirty_bytes_per_line * lines);
+	MemSetT(_dirty_block_spans, 0, lines);
 
 	/* check the dirty rect */
 	if (_invalid_rect.right >= _screen.width) _invalid_rect.right = _screen.width;
@@ -1302,11 +1327,8 @@ void RedrawScreenRect(int left, int top, int right, int bottom)
  */
 void DrawDirtyBlocks()
 {
-	byte *b = _dirty_blocks;
 	const int w = Align(_screen.width,  DIRTY_BLOCK_WIDTH);
 	const int h = Align(_screen.height, DIRTY_BLOCK_HEIGHT);
-	int x;
-	int y;
 
 	if (HasModalProgress()) {
 		/* We are generating the world, so release our rights to the map and
@@ -1327,67 +1349,56 @@ void DrawDirtyBlocks()
 		if (_switch_mode != SM_NONE && !HasModalProgress()) return;
 	}
 
-	y = 0;
-	do {
-		x = 0;
-		do {
-			if (*b != 0) {
-				int left;
-				int top;
-				int right = x + DIRTY_BLOCK_WIDTH;
-				int bottom = y;
-				byte *p = b;
-				int h2;
-
-				/* First try coalescing downwards */
-				do {
-					*p = 0;
-					p += _dirty_bytes_per_line;
-					bottom += DIRTY_BLOCK_HEIGHT;
-				} while (bottom != h && *p != 0);
-
-				/* Try coalescing to the right too. */
-				h2 = (bottom - y) / DIRTY_BLOCK_HEIGHT;
-				assert(h2 > 0);
-				p = b;
-
-				while (right != w) {
-					byte *p2 = ++p;
-					int h = h2;
-					/* Check if a full line of dirty flags is set. */
-					do {
-						if (!*p2) goto no_more_coalesc;
-						p2 += _dirty_bytes_per_line;
-					} while (--h != 0);
-
-					/* Wohoo, can combine it one step to the right!
-					 * Do that, and clear the bits. */
-					right += DIRTY_BLOCK_WIDTH;
-
-					h = h2;
-					p2 = p;
-					do {
-						*p2 = 0;
-						p2 += _dirty_bytes_per_line;
-					} while (--h != 0);
-				}
-				no_more_coalesc:
-
-				left = x;
-				top = y;
-
-				if (left   < _invalid_rect.left  ) left   = _invalid_rect.left;
-				if (top    < _invalid_rect.top   ) top    = _invalid_rect.top;
-				if (right  > _invalid_rect.right ) right  = _invalid_rect.right;
-				if (bottom > _invalid_rect.bottom) bottom = _invalid_rect.bottom;
-
-				if (left < right && top < bottom) {
-					RedrawScreenRect(left, top, right, bottom);
-				}
+	const uint lines = CeilDiv(_screen.height, DIRTY_BLOCK_HEIGHT);
+	bool redrawn = false;
+
+	for (uint y = 0; y < lines; y++) {
+		/* Take the span before redrawing, so blocks marked dirty while redrawing extend it again. */
+		DirtyBlockSpan span = _dirty_block_spans[y];
+		_dirty_block_spans[y].left = 0;
+		_dirty_block_spans[y].right = 0;
+
+		for (uint x = span.left; x < span.right; x++) {
+			byte *b = _dirty_blocks + y * _dirty_bytes_per_line + x;
+			if (*b == 0) continue;
+
+			/* Coalesce to the right first; wide rectangles are cheaper to
+			 * redraw than tall ones as they cross fewer windows. All blocks
+			 * right of the span of a line are clean. */
+			uint right = x + 1;
+			while (right < span.right && b[right - x] != 0) right++;
+
+			/* Then extend downwards as long as the next line is dirty over the whole width. */
+			uint bottom = y + 1;
+			for (; bottom < lines; bottom++) {
+				const byte *p = _dirty_blocks + bottom * _dirty_bytes_per_line + x;
+				uint i = 0;
+				while (i < right - x && p[i] != 0) i++;
+				if (i != right - x) break;
+			}
+
+			for (uint line = y; line < bottom; line++) {
+				MemSetT(_dirty_blocks + line * _dirty_bytes_per_line + x, 0, right - x);
+			}
 
+			/* Only redraw what is within the invalid rectangle. */
+			int draw_left   = max<int>(x * DIRTY_BLOCK_WIDTH,       _invalid_rect.left);
+			int draw_top    = max<int>(y * DIRTY_BLOCK_HEIGHT,      _invalid_rect.top);
+			int draw_right  = min<int>(right * DIRTY_BLOCK_WIDTH,   _invalid_rect.right);
+			int draw_bottom = min<int>(bottom * DIRTY_BLOCK_HEIGHT, _invalid_rect.bottom);
+
+			if (draw_left < draw_right && draw_top < draw_bottom) {
+				RedrawScreenRect(draw_left, draw_top, draw_right, draw_bottom);
+				_dirty_block_stats.redrawn_rects++;
+				_dirty_block_stats.redrawn_pixels += (uint64)(draw_right - draw_left) * (draw_bottom - draw_top);
+				redrawn = true;
 			}
-		} while (b++, (x += DIRTY_BLOCK_WIDTH) != w);
-	} while (b += -(int)(w / DIRTY_BLOCK_WIDTH) + _dirty_bytes_per_line, (y += DIRTY_BLOCK_HEIGHT) != h);
+
+			x = right - 1;
+		}
+	}
+
+	if (redrawn) _dirty_block_stats.frames++;
 
 	++_dirty_block_colour;
 	_invalid_rect.left = w;
@@ -1424,6 +1435,9 @@ void SetDirtyBlocks(int left, int top, int right, int bottom)
 
 	if (left >= right || top >= bottom) return;
 
+	_dirty_block_stats.marked_areas++;
+	_dirty_block_stats.marked_pixels += (uint64)(right - left) * (bottom - top);
+
 	if (left   < _invalid_rect.left  ) _invalid_rect.left   = left;
 	if (top    < _invalid_rect.top   ) _invalid_rect.top    = top;
 	if (right  > _invalid_rect.right ) _invalid_rect.right  = right;
@@ -1439,15 +1453,48 @@ void SetDirtyBlocks(int left, int top, int right, int bottom)
 
 	assert(width > 0 && height > 0);
 
+	DirtyBlockSpan *span = _dirty_block_spans + top;
 	do {
 		int i = width;
 
 		do b[--i] = 0xFF; while (i != 0);
 
+		if (span->right == 0) {
+			span->left = left;
+			span->right = left + width;
+		} else {
+			span->left = min<uint>(span->left, left);
+			span->right = max<uint>(span->right, left + width);
+		}
+
 		b += _dirty_bytes_per_line;
+		span++;
 	} while (--height != 0);
 }
 
+/**
+ * Print the statistics about marking parts of the screen dirty and
+ * redrawing them to the console.
+ * @param reset Whether to start collecting new statistics afterwards.
+ */
+void ConPrintDirtyBlockStats(bool reset)
+{
+	const DirtyBlockStats &st = _dirty_block_stats;
+	uint64 frames = max<uint64>(st.frames, 1);
+
+	IConsolePrintF(CC_DEFAULT, "Frames with redraws: " OTTD_PRINTF64, (int64)st.frames);
+	IConsolePrintF(CC_DEFAULT, "Areas marked dirty:  " OTTD_PRINTF64 " (" OTTD_PRINTF64 " per frame)", (int64)st.marked_areas, (int64)(st.marked_areas / frames));
+	IConsolePrintF(CC_DEFAULT, "Pixels marked dirty: " OTTD_PRINTF64 " (" OTTD_PRINTF64 " per frame)", (int64)st.marked_pixels, (int64)(st.marked_pixels / frames));
+	IConsolePrintF(CC_DEFAULT, "Rectangles redrawn:  " OTTD_PRINTF64 " (" OTTD_PRINTF64 " per frame)", (int64)st.redrawn_rects, (int64)(st.redrawn_rects / frames));
+	IConsolePrintF(CC_DEFAULT, "Pixels redrawn:      " OTTD_PRINTF64 " (" OTTD_PRINTF64 " per frame)", (int64)st.redrawn_pixels, (int64)(st.redrawn_pixels / frames));
+	if (st.marked_pixels != 0) {
+		IConsolePrintF(CC_DEFAULT, "Redrawn per marked pixel: %u.%02u",
+				(uint)(st.redrawn_pixels / st.marked_pixels), (uint)(st.redrawn_pixels * 100 / st.marked_pixels % 100));
+	}
+
+	if (reset) MemSetT(&_dirty_block_stats, 0);
+}
+
 /**
  * This function mark the whole screen as dirty. This results in repainting
  * the whole screen. Use this with care as this function will break the
@@ -1456,6 +1503,8 @@ void SetDirtyBlocks(int left, int top, int right, int bottom)
  */
 void MarkWholeScreenDirty()
 {
+	/* Whatever changed may affect the drawing of any tile. */
+	ClearViewportTileCache();
 	SetDirtyBlocks(0, 0, _screen.width, _screen.height);
 }
 
@@ -19,6 +19,11 @@
 #include "blitter/factory.hpp"
 #include "video/video_driver.hpp"
 #include "window_func.h"
+#include "spritecache.h"
+#include "zoom_func.h"
+#include "console_func.h"
+#include "settings_type.h"
+#include "framerate_type.h"
 
 /* The type of set we're replacing */
 #define SET_TYPE "graphics"
@@ -277,9 +282,11 @@ static bool SwitchNewGRFBlitter()
 		uint min_base_depth, max_base_depth, min_grf_depth, max_grf_depth;
 	} replacement_blitters[] = {
 #ifdef WITH_SSE
+		{ "32bpp-avx2",      0, 32, 32,  8, 32 },
 		{ "32bpp-sse4",      0, 32, 32,  8, 32 },
 		{ "32bpp-ssse3",     0, 32, 32,  8, 32 },
 		{ "32bpp-sse2",      0, 32, 32,  8, 32 },
+		{ "32bpp-avx2-anim", 1, 32, 32,  8, 32 },
 		{ "32bpp-sse4-anim", 1, 32, 32,  8, 32 },
 #endif
 		{ "8bpp-optimized",  2,  8,  8,  8,  8 },
@@ -350,6 +357,132 @@ void GfxLoadSprites()
 	UpdateCursorSize();
 }
 
+/** Width and height of the off-screen buffer the blitter benchmark draws into. */
+static const int BLITTER_BENCHMARK_SIZE = 512;
+
+/** Allocator for the sprites encoded by the blitter benchmark. */
+static void *BlitterBenchmarkAlloc(size_t size)
+{
+	return MallocT<byte>(size);
+}
+
+/**
+ * Measure how fast every usable blitter draws the sprites of the base graphics and fills rectangles.
+ * Each blitter gets the sprites encoded in its own format and draws into an off-screen buffer,
+ * so the current blitter and the sprite cache are left alone. Blitters that keep their own
+ * palette animation buffer for the screen cannot draw off-screen and are skipped.
+ * @param rounds How often to draw all sprites per blitter, mode and zoom level.
+ */
+void BenchmarkBlitters(uint rounds)
+{
+	static const BlitterMode modes[] = { BM_NORMAL, BM_COLOUR_REMAP, BM_TRANSPARENT };
+	static const char * const mode_names[] = { "normal", "remap", "transparent" };
+
+	SmallVector<SpriteID, 256> sprites;
+	for (SpriteID id = 0; id < SPR_OPENTTD_BASE; id++) {
+		if (SpriteExists(id) && GetSpriteType(id) == ST_NORMAL) *sprites.Append() = id;
+	}
+	const byte *remap = GetNonSprite(PALETTE_TO_RED, ST_RECOLOUR) + 1;
+
+	SmallVector<Blitter *, 16> blitters;
+	BlitterFactory::CreateAllInstances(blitters);
+
+	IConsolePrintF(CC_INFO, "Drawing %u sprites %u times per mode and zoom level into a %dx%d buffer", sprites.Length(), rounds, BLITTER_BENCHMARK_SIZE, BLITTER_BENCHMARK_SIZE);
+
+	/* We are no longer rendering to the screen; the rectangle functions use _screen's pitch. */
+	DrawPixelInfo old_screen = _screen;
+	bool old_disable_anim = _screen_disable_anim;
+	_screen_disable_anim = true;
+
+	for (Blitter **it = blitters.Begin(); it != blitters.End(); it++) {
+		Blitter *blitter = *it;
+		if (blitter->GetScreenDepth() == 0 || blitter->UsePaletteAnimation() == Blitter::PALETTE_ANIMATION_BLITTER) {
+			IConsolePrintF(CC_DEFAULT, "%-18s skipped, it can only draw to the screen", blitter->GetName());
+			continue;
+		}
+
+		SmallVector<Sprite *, 256> encoded;
+		for (const SpriteID *id = sprites.Begin(); id != sprites.End(); id++) {
+			*encoded.Append() = (Sprite *)GetRawSprite(*id, ST_NORMAL, BlitterBenchmarkAlloc, blitter);
+		}
+
+		byte *buffer = CallocT<byte>(BLITTER_BENCHMARK_SIZE * BLITTER_BENCHMARK_SIZE * blitter->GetScreenDepth() / 8);
+		_screen.dst_ptr = buffer;
+		_screen.width = BLITTER_BENCHMARK_SIZE;
+		_screen.height = BLITTER_BENCHMARK_SIZE;
+		_screen.pitch = BLITTER_BENCHMARK_SIZE;
+
+		for (ZoomLevel zoom = _settings_client.gui.zoom_min; zoom <= _settings_client.gui.zoom_max; zoom++) {
+			char line[256];
+			char *p = line + seprintf(line, lastof(line), "%-18s zoom %d:", blitter->GetName(), zoom);
+
+			for (uint m = 0; m < lengthof(modes); m++) {
+				uint64 pixels = 0;
+				TimingMeasurement start = GetPerformanceTimer();
+				for (uint r = 0; r < rounds; r++) {
+					/* Place the sprites next to each other in rows, wrapping around at the end of the buffer. */
+					int x = 0;
+					int y = 0;
+					int row_height = 0;
+					for (Sprite **s = encoded.Begin(); s != encoded.End(); s++) {
+						Blitter::BlitterParams bp;
+						bp.sprite = (*s)->data;
+						bp.remap = remap;
+						bp.skip_left = 0;
+						bp.skip_top = 0;
+						bp.width = min(UnScaleByZoom((*s)->width, zoom), BLITTER_BENCHMARK_SIZE);
+						bp.height = min(UnScaleByZoom((*s)->height, zoom), BLITTER_BENCHMARK_SIZE);
+						bp.sprite_width = (*s)->width;
+						bp.sprite_height = (*s)->height;
+
+						if (x + bp.width > BLITTER_BENCHMARK_SIZE) {
+							x = 0;
+							y += row_height;
+							row_height = 0;
+						}
+						if (y + bp.height > BLITTER_BENCHMARK_SIZE) y = 0;
+
+						bp.left = x;
+						bp.top = y;
+						bp.dst = buffer;
+						bp.pitch = BLITTER_BENCHMARK_SIZE;
+						blitter->Draw(&bp, modes[m], zoom);
+
+						pixels += bp.width * bp.height;
+						x += bp.width;
+						row_height = max(row_height, bp.height);
+					}
+				}
+				TimingMeasurement duration = max<TimingMeasurement>(GetPerformanceTimer() - start, 1);
+				p += seprintf(p, lastof(line), " %s %.1f Mpx/s", mode_names[m], (double)pixels / duration);
+			}
+			IConsolePrint(CC_DEFAULT, line);
+		}
+
+		/* Rectangles as drawn by GfxFillRect, covering the whole buffer. */
+		TimingMeasurement start = GetPerformanceTimer();
+		for (uint r = 0; r < rounds; r++) {
+			blitter->DrawRect(buffer, BLITTER_BENCHMARK_SIZE, BLITTER_BENCHMARK_SIZE, PC_DARK_BLUE);
+		}
+		TimingMeasurement fill = max<TimingMeasurement>(GetPerformanceTimer() - start, 1);
+		start = GetPerformanceTimer();
+		for (uint r = 0; r < rounds; r++) {
+			blitter->DrawColourMappingRect(buffer, BLITTER_BENCHMARK_SIZE, BLITTER_BENCHMARK_SIZE, PALETTE_TO_TRANSPARENT);
+		}
+		TimingMeasurement shade = max<TimingMeasurement>(GetPerformanceTimer() - start, 1);
+		uint64 rect_pixels = (uint64)rounds * BLITTER_BENCHMARK_SIZE * BLITTER_BENCHMARK_SIZE;
+		IConsolePrintF(CC_DEFAULT, "%-18s rectangles: fill %.1f Mpx/s, shade %.1f Mpx/s", blitter->GetName(), (double)rect_pixels / fill, (double)rect_pixels / shade);
+
+		free(buffer);
+		for (Sprite **s = encoded.Begin(); s != encoded.End(); s++) free(*s);
+	}
+
+	_screen = old_screen;
+	_screen_disable_anim = old_disable_anim;
+
+	for (Blitter **it = blitters.Begin(); it != blitters.End(); it++) delete *it;
+}
+
 bool GraphicsSet::FillSetDetails(IniFile *ini, const char *path, const char *full_filename)
 {
 	bool ret = this->BaseSet<GraphicsSet, MAX_GFT, true>::FillSetDetails(ini, path, full_filename, false);
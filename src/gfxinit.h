@@ -13,5 +13,6 @@
 #define GFXINIT_H
 
 void GfxLoadSprites();
+void BenchmarkBlitters(uint rounds);
 
 #endif /* GFXINIT_H */
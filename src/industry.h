@@ -16,6 +16,7 @@
 #include "subsidy_type.h"
 #include "industry_map.h"
 #include "tilearea_type.h"
+#include "station_type.h"
 
 
 typedef Pool<Industry, IndustryID, 64, 64000> IndustryPool;
@@ -50,7 +51,7 @@ struct Industry : IndustryPool::PoolItem<&_industry_pool> {
 	byte last_month_pct_transported[2]; ///< percentage transported per cargo in the last full month
 	uint16 last_month_production[2];    ///< total units produced per cargo in the last full month
 	uint16 last_month_transported[2];   ///< total units transported per cargo in the last full month
-	uint16 counter;                     ///< used for animation and/or production (if available cargo)
+	uint16 counter;                     ///< used for animation and/or production (if available cargo); offset by #counter_ticks, @see GetCounter()
 
 	IndustryType type;                  ///< type of industry.
 	OwnerByte owner;                    ///< owner of the industry.  Which SHOULD always be (imho) OWNER_NONE
@@ -70,10 +71,36 @@ struct Industry : IndustryPool::PoolItem<&_industry_pool> {
 
 	PersistentStorage *psa;             ///< Persistent storage for NewGRF industries.
 
+	StationList stations_near;          ///< NOSAVE: Cached list of stations the industry can deliver its production to, @see TransportIndustryGoods()
+
+	static uint16 counter_ticks;        ///< Number of industry ticks since the counters were last synchronised, @see SyncIndustryCounters()
+
 	Industry(TileIndex tile = INVALID_TILE) : location(tile, 0, 0) {}
 	~Industry();
 
 	void RecomputeProductionMultipliers();
+	void RecomputeStationsNear();
+	static void RecomputeStationsNearForAll();
+
+	/**
+	 * Get the production counter of the industry.
+	 * The counters of all industries are decremented together by
+	 * incrementing #counter_ticks, instead of touching every industry.
+	 * @return The current counter value.
+	 */
+	inline uint16 GetCounter() const
+	{
+		return this->counter - Industry::counter_ticks;
+	}
+
+	/**
+	 * Set the production counter of the industry.
+	 * @param counter The new counter value.
+	 */
+	inline void SetCounter(uint16 counter)
+	{
+		this->counter = counter + Industry::counter_ticks;
+	}
 
 	/**
 	 * Check if a given tile belongs to this industry.
@@ -144,6 +171,8 @@ protected:
 
 void PlantRandomFarmField(const Industry *i);
 
+void SyncIndustryCounters();
+
 void ReleaseDisastersTargetingIndustry(IndustryID);
 
 bool IsTileForestIndustry(TileIndex tile);
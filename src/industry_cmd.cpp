@@ -58,6 +58,20 @@ static byte _industry_sound_ctr;
 static TileIndex _industry_sound_tile;
 
 uint16 Industry::counts[NUM_INDUSTRYTYPES];
+uint16 Industry::counter_ticks;
+
+/**
+ * Number of phases of the industry tick schedule. Sounds are considered every
+ * 64 ticks and production happens every #INDUSTRY_PRODUCE_TICKS, so an
+ * industry only needs to be visited in one out of 64 ticks.
+ */
+static const uint INDUSTRY_TICK_PHASES = 64;
+
+/**
+ * Industries bucketed by the phase of their stored counter, each bucket
+ * sorted by industry index, @see OnTick_Industry().
+ */
+static SmallVector<IndustryID, 16> _industry_tick_schedule[INDUSTRY_TICK_PHASES];
 
 IndustrySpec _industry_specs[NUM_INDUSTRYTYPES];
 IndustryTileSpec _industry_tile_specs[NUM_INDUSTRYTILES];
@@ -133,10 +147,56 @@ const IndustryTileSpec *GetIndustryTileSpec(IndustryGfx gfx)
 	return &_industry_tile_specs[gfx];
 }
 
+/**
+ * Add an industry to the tick schedule.
+ * @param i The industry, with its counter already set.
+ */
+static void ScheduleIndustryTick(const Industry *i)
+{
+	SmallVector<IndustryID, 16> &bucket = _industry_tick_schedule[i->counter % INDUSTRY_TICK_PHASES];
+
+	/* Keep the bucket in pool order, so industries are processed in the same order as they are in the pool. */
+	IndustryID *pos = bucket.Begin();
+	while (pos != bucket.End() && *pos < i->index) pos++;
+	*bucket.Insert(pos) = i->index;
+}
+
+/**
+ * Remove an industry from the tick schedule.
+ * @param i The industry.
+ */
+static void UnscheduleIndustryTick(const Industry *i)
+{
+	SmallVector<IndustryID, 16> &bucket = _industry_tick_schedule[i->counter % INDUSTRY_TICK_PHASES];
+
+	IndustryID *pos = bucket.Find(i->index);
+	if (pos != bucket.End()) bucket.ErasePreservingOrder(pos);
+}
+
+/**
+ * Store the current counter value in all industries and rebuild the tick
+ * schedule. Used before saving so the savegame contains the actual counters,
+ * and after loading.
+ */
+void SyncIndustryCounters()
+{
+	for (uint p = 0; p < INDUSTRY_TICK_PHASES; p++) _industry_tick_schedule[p].Clear();
+
+	Industry *i;
+	FOR_ALL_INDUSTRIES(i) {
+		i->counter = i->GetCounter();
+		*_industry_tick_schedule[i->counter % INDUSTRY_TICK_PHASES].Append() = i->index;
+	}
+
+	Industry::counter_ticks = 0;
+}
+
 Industry::~Industry()
 {
 	if (CleaningPool()) return;
 
+	UnscheduleIndustryTick(this);
+
 	/* Industry can also be destroyed when not fully initialized.
 	 * This means that we do not have to clear tiles either.
 	 * Also we must not decrement industry counts in that case. */
@@ -502,8 +562,6 @@ static bool TransportIndustryGoods(TileIndex tile)
 	const IndustrySpec *indspec = GetIndustrySpec(i->type);
 	bool moved_cargo = false;
 
-	StationFinder stations(i->location);
-
 	for (uint j = 0; j < lengthof(i->produced_cargo_waiting); j++) {
 		uint cw = min(i->produced_cargo_waiting[j], 255);
 		if (cw > indspec->minimal_cargo && i->produced_cargo[j] != CT_INVALID) {
@@ -514,7 +572,7 @@ static bool TransportIndustryGoods(TileIndex tile)
 
 			i->this_month_production[j] += cw;
 
-			uint am = MoveGoodsToStation(i->produced_cargo[j], cw, ST_INDUSTRY, i->index, stations.GetStations());
+			uint am = MoveGoodsToStation(i->produced_cargo[j], cw, ST_INDUSTRY, i->index, &i->stations_near);
 			i->this_month_transported[j] += am;
 
 			moved_cargo |= (am != 0);
@@ -1096,12 +1154,17 @@ static void ChopLumberMillTrees(Industry *i)
 	}
 }
 
+/**
+ * Handle the periodic sounds and cargo production of an industry.
+ * @param i The industry; its counter has already been decremented for this tick.
+ */
 static void ProduceIndustryGoods(Industry *i)
 {
 	const IndustrySpec *indsp = GetIndustrySpec(i->type);
+	uint16 counter = i->GetCounter();
 
 	/* play a sound? */
-	if ((i->counter & 0x3F) == 0) {
+	if (((counter + 1) & 0x3F) == 0) {
 		uint32 r;
 		uint num;
 		if (Chance16R(1, 14, r) && (num = indsp->number_of_sounds) != 0 && _settings_client.sound.ambient) {
@@ -1111,10 +1174,8 @@ static void ProduceIndustryGoods(Industry *i)
 		}
 	}
 
-	i->counter--;
-
 	/* produce some cargo */
-	if ((i->counter % INDUSTRY_PRODUCE_TICKS) == 0) {
+	if ((counter % INDUSTRY_PRODUCE_TICKS) == 0) {
 		if (HasBit(indsp->callback_mask, CBM_IND_PRODUCTION_256_TICKS)) IndustryProductionCallback(i, 1);
 
 		IndustryBehaviour indbehav = indsp->behaviour;
@@ -1146,7 +1207,7 @@ static void ProduceIndustryGoods(Industry *i)
 			if (cb_res != CALLBACK_FAILED) {
 				cut = ConvertBooleanCallback(indsp->grf_prop.grffile, CBID_INDUSTRY_SPECIAL_EFFECT, cb_res);
 			} else {
-				cut = ((i->counter % INDUSTRY_CUT_TREE_TICKS) == 0);
+				cut = ((counter % INDUSTRY_CUT_TREE_TICKS) == 0);
 			}
 
 			if (cut) ChopLumberMillTrees(i);
@@ -1172,9 +1233,19 @@ void OnTick_Industry()
 
 	if (_game_mode == GM_EDITOR) return;
 
-	Industry *i;
-	FOR_ALL_INDUSTRIES(i) {
-		ProduceIndustryGoods(i);
+	/* Decrement the counters of all industries at once. Only the industries
+	 * whose counter was a multiple of 64 (sounds) or now is one (production)
+	 * have something to do; those are in exactly two phases of the schedule. */
+	const SmallVector<IndustryID, 16> &sound = _industry_tick_schedule[Industry::counter_ticks % INDUSTRY_TICK_PHASES];
+	Industry::counter_ticks++;
+	const SmallVector<IndustryID, 16> &produce = _industry_tick_schedule[Industry::counter_ticks % INDUSTRY_TICK_PHASES];
+
+	/* Merge both phases, so the industries are handled in pool order like they always were. */
+	const IndustryID *s = sound.Begin();
+	const IndustryID *p = produce.Begin();
+	while (s != sound.End() || p != produce.End()) {
+		IndustryID index = (p == produce.End() || (s != sound.End() && *s < *p)) ? *s++ : *p++;
+		ProduceIndustryGoods(Industry::Get(index));
 	}
 }
 
@@ -1667,7 +1738,8 @@ static void DoCreateNewIndustry(Industry *i, TileIndex tile, IndustryType type,
 
 	uint16 r = Random();
 	i->random_colour = GB(r, 0, 4);
-	i->counter = GB(r, 4, 12);
+	i->SetCounter(GB(r, 4, 12));
+	ScheduleIndustryTick(i);
 	i->random = initial_random_bits;
 	i->produced_cargo_waiting[0] = 0;
 	i->produced_cargo_waiting[1] = 0;
@@ -1784,6 +1856,7 @@ static void DoCreateNewIndustry(Industry *i, TileIndex tile, IndustryType type,
 	InvalidateWindowData(WC_INDUSTRY_DIRECTORY, 0, 0);
 
 	Station::RecomputeIndustriesNearForAll();
+	i->RecomputeStationsNear();
 }
 
 /**
@@ -2198,6 +2271,27 @@ void Industry::RecomputeProductionMultipliers()
 	this->production_rate[1] = min(CeilDiv(indspec->production_rate[1] * this->prod_level, PRODLEVEL_DEFAULT), 0xFF);
 }
 
+/**
+ * Recomputes Industry::stations_near, the list of stations whose
+ * catchment covers the industry.
+ */
+void Industry::RecomputeStationsNear()
+{
+	this->stations_near.Clear();
+	if (this->location.w == 0) return;
+
+	FindStationsAroundTiles(this->location, &this->stations_near);
+}
+
+/**
+ * Recomputes Industry::stations_near for all industries.
+ */
+/* static */ void Industry::RecomputeStationsNearForAll()
+{
+	Industry *i;
+	FOR_ALL_INDUSTRIES(i) i->RecomputeStationsNear();
+}
+
 
 /**
  * Set the #probability and #min_number fields for the industry type \a it for a running game.
@@ -2388,8 +2482,7 @@ static void CanCargoServiceIndustry(CargoID cargo, Industry *ind, bool *c_accept
 static int WhoCanServiceIndustry(Industry *ind)
 {
 	/* Find all stations within reach of the industry */
-	StationList stations;
-	FindStationsAroundTiles(ind->location, &stations);
+	const StationList &stations = ind->stations_near;
 
 	if (stations.Length() == 0) return 0; // No stations found at all => nobody services
 
@@ -2488,7 +2581,7 @@ static void ChangeIndustryProduction(Industry *i, bool monthly)
 
 	bool callback_enabled = HasBit(indspec->callback_mask, monthly ? CBM_IND_MONTHLYPROD_CHANGE : CBM_IND_PRODUCTION_CHANGE);
 	if (callback_enabled) {
-		uint16 res = GetIndustryCallback(monthly ? CBID_INDUSTRY_MONTHLYPROD_CHANGE : CBID_INDUSTRY_PRODUCTION_CHANGE, 0, Random(), i, i->type, i->location.tile);
+		uint16 res = GetIndustryProductionChangeCallback(monthly, Random(), i);
 		if (res != CALLBACK_FAILED) { // failed callback means "do nothing"
 			suppress_message = HasBit(res, 7);
 			/* Get the custom message if any */
@@ -2745,6 +2838,9 @@ void InitializeIndustries()
 	Industry::ResetIndustryCounts();
 	_industry_sound_tile = 0;
 
+	for (uint p = 0; p < INDUSTRY_TICK_PHASES; p++) _industry_tick_schedule[p].Clear();
+	Industry::counter_ticks = 0;
+
 	_industry_builder.Reset();
 }
 
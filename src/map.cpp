@@ -29,6 +29,7 @@ uint _map_size_y;    ///< Size of the map along the Y
 uint _map_size;      ///< The number of tiles on the map
 uint _map_tile_mask; ///< _map_size - 1 (to mask the mapsize)
 
+TileBase *_mb = NULL;     ///< Type and height of the tiles of the map
 Tile *_m = NULL;          ///< Tiles of the map
 TileExtended *_me = NULL; ///< Extended Tiles of the map
 
@@ -45,11 +46,13 @@ void AllocateMap(uint size_x, uint size_y)
 	if (!IsInsideMM(size_x, MIN_MAP_SIZE, MAX_MAP_SIZE + 1) ||
 			!IsInsideMM(size_y, MIN_MAP_SIZE, MAX_MAP_SIZE + 1) ||
 			(size_x & (size_x - 1)) != 0 ||
-			(size_y & (size_y - 1)) != 0) {
+			(size_y & (size_y - 1)) != 0 ||
+			size_x * size_y > MAX_MAP_TILES) {
 		error("Invalid map size");
 	}
 
-	DEBUG(map, 1, "Allocating map of size %dx%d", size_x, size_y);
+	DEBUG(map, 1, "Allocating map of size %dx%d (%u KiB)", size_x, size_y,
+			(uint)((size_x * size_y * (sizeof(TileBase) + sizeof(Tile) + sizeof(TileExtended))) >> 10));
 
 	_map_log_x = FindFirstBit(size_x);
 	_map_log_y = FindFirstBit(size_y);
@@ -58,9 +61,11 @@ void AllocateMap(uint size_x, uint size_y)
 	_map_size = size_x * size_y;
 	_map_tile_mask = _map_size - 1;
 
+	free(_mb);
 	free(_m);
 	free(_me);
 
+	_mb = CallocT<TileBase>(_map_size);
 	_m = CallocT<Tile>(_map_size);
 	_me = CallocT<TileExtended>(_map_size);
 }
@@ -27,6 +27,14 @@ extern uint _map_tile_mask;
 
 #define TILE_MASK(x) ((x) & _map_tile_mask)
 
+/**
+ * Pointer to the base tile-array.
+ *
+ * This variable points to the array with the type and height of the
+ * tiles of the map.
+ */
+extern TileBase *_mb;
+
 /**
  * Pointer to the tile-array.
  *
@@ -124,8 +132,9 @@ static inline uint MapMaxY()
 static inline uint ScaleByMapSize(uint n)
 {
 	/* Subtract 12 from shift in order to prevent integer overflow
-	 * for large values of n. It's safe since the min mapsize is 64x64. */
-	return CeilDiv(n << (MapLogX() + MapLogY() - 12), 1 << 4);
+	 * for large values of n. It's safe since the min mapsize is 64x64.
+	 * Maps can have 2^14 times the tiles of a 64x64 map, so shift in 64 bits. */
+	return (uint)((((uint64)n << (MapLogX() + MapLogY() - 12)) + (1 << 4) - 1) >> 4);
 }
 
 
@@ -13,12 +13,23 @@
 #define MAP_TYPE_H
 
 /**
- * Data that is stored per tile. Also used TileExtended for this.
+ * Data that is stored per tile and needed by almost every lookup of a tile.
+ * It is kept apart from Tile and TileExtended so loops that only check the
+ * type or height of tiles pull in far fewer cache lines.
  * Look at docs/landscape.html for the exact meaning of the members.
  */
-struct Tile {
+struct TileBase {
 	byte   type;        ///< The type (bits 4..7), bridges (2..3), rainforest/desert (0..1)
 	byte   height;      ///< The height of the northern corner.
+};
+
+assert_compile(sizeof(TileBase) == 2);
+
+/**
+ * Data that is stored per tile. Also used TileBase and TileExtended for this.
+ * Look at docs/landscape.html for the exact meaning of the members.
+ */
+struct Tile {
 	uint16 m2;          ///< Primarily used for indices to towns, industries and stations
 	byte   m1;          ///< Primarily used for ownership information
 	byte   m3;          ///< General purpose
@@ -26,10 +37,10 @@ struct Tile {
 	byte   m5;          ///< General purpose
 };
 
-assert_compile(sizeof(Tile) == 8);
+assert_compile(sizeof(Tile) == 6);
 
 /**
- * Data that is stored per tile. Also used Tile for this.
+ * Data that is stored per tile. Also used TileBase and Tile for this.
  * Look at docs/landscape.html for the exact meaning of the members.
  */
 struct TileExtended {
@@ -63,9 +74,13 @@ struct TileIndexDiffC {
 
 /** Minimal and maximal map width and height */
 static const uint MIN_MAP_SIZE_BITS = 6;                      ///< Minimal size of map is equal to 2 ^ MIN_MAP_SIZE_BITS
-static const uint MAX_MAP_SIZE_BITS = 12;                     ///< Maximal size of map is equal to 2 ^ MAX_MAP_SIZE_BITS
+static const uint MAX_MAP_SIZE_BITS = 14;                     ///< Maximal size of map is equal to 2 ^ MAX_MAP_SIZE_BITS
 static const uint MIN_MAP_SIZE      = 1 << MIN_MAP_SIZE_BITS; ///< Minimal map size = 64
-static const uint MAX_MAP_SIZE      = 1 << MAX_MAP_SIZE_BITS; ///< Maximal map size = 4096
+static const uint MAX_MAP_SIZE      = 1 << MAX_MAP_SIZE_BITS; ///< Maximal map size = 16384
+
+/** Maximal number of tiles of a map */
+static const uint MAX_MAP_TILES_BITS = 26;                     ///< Maximal number of tiles of a map is equal to 2 ^ MAX_MAP_TILES_BITS, e.g. 8192x8192 or 16384x4096
+static const uint MAX_MAP_TILES      = 1 << MAX_MAP_TILES_BITS; ///< Maximal number of tiles of a map
 
 /**
  * Approximation of the length of a straight track, relative to a diagonal
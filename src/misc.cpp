@@ -23,6 +23,7 @@
 #include "gamelog.h"
 #include "animated_tile_func.h"
 #include "tilehighlight_func.h"
+#include "viewport_func.h"
 #include "network/network_func.h"
 #include "window_func.h"
 #include "core/pool_type.hpp"
@@ -58,6 +59,7 @@ void InitializeGame(uint size_x, uint size_y, bool reset_date, bool reset_settin
 	UnInitWindowSystem();
 
 	AllocateMap(size_x, size_y);
+	ClearViewportTileCache();
 
 	_pause_mode = PM_UNPAUSED;
 	_fast_forward = 0;
@@ -18,6 +18,7 @@
 #include "fileio_func.h"
 #include "engine_func.h"
 #include "engine_base.h"
+#include "engine_gui.h"
 #include "bridge.h"
 #include "town.h"
 #include "newgrf_engine.h"
@@ -33,6 +34,7 @@
 #include "newgrf_canal.h"
 #include "newgrf_townname.h"
 #include "newgrf_industries.h"
+#include "newgrf_industrytiles.h"
 #include "newgrf_airporttiles.h"
 #include "newgrf_airport.h"
 #include "newgrf_object.h"
@@ -4746,6 +4748,8 @@ static void NewSpriteGroup(ByteReader *buf)
 				group->ranges = MallocT<DeterministicSpriteGroupRange>(group->num_ranges);
 				MemCpyT(group->ranges, &optimised.front(), group->num_ranges);
 			}
+
+			group->Optimise();
 			break;
 		}
 
@@ -8159,6 +8163,11 @@ void ResetNewGRFData()
 
 	InitializeSoundPool();
 	_spritegroup_pool.CleanPool();
+	ResetHouseCaches();
+	ResetVehicleSpriteCache();
+	ResetIndustryTileDrawCache();
+	ResetIndustryCallbackResults();
+	InvalidateEngineSortKeys();
 }
 
 /**
@@ -8905,7 +8914,7 @@ void LoadNewGRFFile(GRFConfig *config, uint file_index, GrfLoadingStage stage, S
 	if (stage == GLS_INIT || stage == GLS_ACTIVATION) {
 		/* We need the sprite offsets in the init stage for NewGRF sounds
 		 * and in the activation stage for real sprites. */
-		ReadGRFSpriteOffsets(_cur.grf_container_ver);
+		ReadGRFSpriteOffsets(_cur.grf_container_ver, filename, subdir);
 	} else {
 		/* Skip sprite section offset if present. */
 		if (_cur.grf_container_ver >= 2) FioReadDword();
@@ -9263,6 +9272,16 @@ void LoadNewGRF(uint load_index, uint file_index, uint num_baseset)
 
 	_cur.spriteid = load_index;
 
+	/* Index the sprite sections of the NewGRFs in the background, while the
+	 * first stages only process the pseudo sprites. The slots, and thus the
+	 * sub directories, are assigned the same way as in the label scan below. */
+	uint prepare_slot = file_index;
+	for (GRFConfig *c = _grfconfig; c != NULL; c = c->next) {
+		if (c->status == GCS_NOT_FOUND) continue;
+		PrepareGRFSpriteOffsets(c->filename, prepare_slot++ < file_index + num_baseset ? BASESET_DIR : NEWGRF_DIR);
+	}
+	StartPreparingGRFSpriteOffsets();
+
 	/* Load newgrf sprites
 	 * in each loading stage, (try to) open each file specified in the config
 	 * and load information from it. */
@@ -9328,6 +9347,7 @@ void LoadNewGRF(uint load_index, uint file_index, uint num_baseset)
 
 	/* Pseudo sprite processing is finished; free temporary stuff */
 	_cur.ClearDataForNextFile();
+	ClearPreparedGRFSpriteOffsets();
 
 	/* Call any functions that should be run after GRFs have been loaded. */
 	AfterLoadGRFs();
@@ -60,6 +60,8 @@ struct AirportResolverObject : public ResolverObject {
 	}
 
 	/* virtual */ const SpriteGroup *ResolveReal(const RealSpriteGroup *group) const;
+
+	/* virtual */ GrfSpecFeature GetFeature() const { return GSF_AIRPORTS; }
 };
 
 /**
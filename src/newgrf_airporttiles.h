@@ -56,6 +56,8 @@ struct AirportTileResolverObject : public ResolverObject {
 			default: return ResolverObject::GetScope(scope, relative);
 		}
 	}
+
+	/* virtual */ GrfSpecFeature GetFeature() const { return GSF_AIRPORTTILES; }
 };
 
 /**
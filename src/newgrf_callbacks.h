@@ -405,5 +405,7 @@ enum AirportTileCallbackMask {
  */
 static const uint CALLBACK_FAILED              = 0xFFFF; ///< Result of a failed callback.
 static const uint CALLBACK_HOUSEPRODCARGO_END  = 0x20FF; ///< Sentinel indicating that the loop for CBID_HOUSE_PRODUCE_CARGO has ended
+static const uint CALLBACK_VARIES              = 0x10000; ///< Callback analysis result: the callback result depends on the object it is resolved for.
+static const uint CALLBACK_UNKNOWN             = 0x20000; ///< Callback analysis result: the callback has not been analysed yet.
 
 #endif /* NEWGRF_CALLBACKS_H */
@@ -50,6 +50,8 @@ struct CanalResolverObject : public ResolverObject {
 	}
 
 	/* virtual */ const SpriteGroup *ResolveReal(const RealSpriteGroup *group) const;
+
+	/* virtual */ GrfSpecFeature GetFeature() const { return GSF_CANALS; }
 };
 
 /* virtual */ uint32 CanalScopeResolver::GetRandomBits() const
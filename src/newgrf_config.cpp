@@ -25,6 +25,11 @@
 #include "fileio_func.h"
 #include "fios.h"
 
+#include <sys/stat.h>
+#include <time.h>
+#include <map>
+#include <string>
+
 #include "safeguards.h"
 
 /** Create a new GRFTextWrapper. */
@@ -364,8 +369,177 @@ size_t GRFGetSizeOfDataSection(FILE *f)
 	return SIZE_MAX;
 }
 
+/*
+ * Only the checksums of NewGRFs are remembered between runs, not their decoded state.
+ * What loading a NewGRF produces is not a function of the NewGRF configuration alone:
+ * - Actions 7, 9 and D read global variables (GetGlobalVariable) such as the current
+ *   date, the climate and game settings, so the same set may load differently later.
+ * - Sprite IDs are handed out in load order after the base set, strings are mapped
+ *   into the global string table and Action D reserves IDs shared by all NewGRFs.
+ * - Specs point into the sprite group pool and to their GRFFile, so they cannot be
+ *   mapped back in without relocating every pointer.
+ * Indexing the real sprites, the bulk of each file, already runs in background threads
+ * while loading. Scanning on the other hand reads every NewGRF in the collection in
+ * full, only for its checksum; that part is cached here.
+ */
+
+char *_grf_md5_cache_file; ///< The file to remember the NewGRF checksums in between runs.
+
+/** Header of the NewGRF checksum cache file; a different header invalidates the whole file. */
+static const char * const GRF_MD5_CACHE_HEADER = "# OpenTTD NewGRF checksum cache, version 2\n";
+
+/** Remembered checksum of a NewGRF, valid as long as the file on disk did not change. */
+struct GRFMD5CacheEntry {
+	uint64 size;      ///< Size of the file (or tar) containing the NewGRF.
+	uint64 mtime;     ///< Modification time of the file, in nanoseconds.
+	uint64 ctime;     ///< Status change time of the file, in nanoseconds.
+	uint64 inode;     ///< Inode number of the file, if the platform has those.
+	uint64 device;    ///< Device the file lives on.
+	uint64 offset;    ///< Offset of the NewGRF within the file; non-zero for NewGRFs inside tars.
+	uint8 md5sum[16]; ///< The checksum of the NewGRF.
+	bool used;        ///< Whether the entry has been looked up during the current scan; unused entries are not saved.
+};
+
+typedef std::map<std::string, GRFMD5CacheEntry> GRFMD5Cache;
+static GRFMD5Cache _grf_md5_cache; ///< Checksums of NewGRFs, keyed on file name.
+static bool _grf_md5_cache_loaded = false; ///< Whether the cache has been read from disk yet.
+static bool _grf_md5_cache_dirty = false;  ///< Whether the cache differs from the one on disk.
+
+/**
+ * Files changed less than this many seconds before their checksum is calculated
+ * are not remembered: a write within the same timestamp granularity (whole seconds
+ * on some platforms, two seconds on FAT) would not change the cached state.
+ */
+static const time_t GRF_MD5_CACHE_RACY_SECONDS = 2;
+
+/** Read the NewGRF checksum cache from disk, if it has not been read yet. */
+static void LoadGRFMD5Cache()
+{
+	if (_grf_md5_cache_loaded) return;
+	_grf_md5_cache_loaded = true;
+
+	if (_grf_md5_cache_file == NULL) return;
+	FILE *f = fopen(_grf_md5_cache_file, "r");
+	if (f == NULL) return;
+
+	char line[MAX_PATH + 256];
+	if (fgets(line, sizeof(line), f) == NULL || strcmp(line, GRF_MD5_CACHE_HEADER) != 0) {
+		DEBUG(grf, 1, "Ignoring NewGRF checksum cache with unknown format");
+		fclose(f);
+		return;
+	}
+
+	while (fgets(line, sizeof(line), f) != NULL) {
+		/* Strip the line ending; lines without one were truncated and are skipped. */
+		char *end = strchr(line, '\n');
+		if (end == NULL) continue;
+		*end = '\0';
+
+		GRFMD5CacheEntry entry;
+		unsigned long long size, mtime, ctime, inode, device, offset;
+		uint md5[16];
+		int key_start = 0;
+		if (sscanf(line, "%2x%2x%2x%2x%2x%2x%2x%2x%2x%2x%2x%2x%2x%2x%2x%2x " OTTD_PRINTFHEX64 " " OTTD_PRINTFHEX64 " " OTTD_PRINTFHEX64 " " OTTD_PRINTFHEX64 " " OTTD_PRINTFHEX64 " " OTTD_PRINTFHEX64 " %n",
+				&md5[0], &md5[1], &md5[2], &md5[3], &md5[4], &md5[5], &md5[6], &md5[7],
+				&md5[8], &md5[9], &md5[10], &md5[11], &md5[12], &md5[13], &md5[14], &md5[15],
+				&size, &mtime, &ctime, &inode, &device, &offset, &key_start) != 22 || key_start == 0 || line[key_start] == '\0') {
+			continue;
+		}
+
+		for (uint i = 0; i < lengthof(entry.md5sum); i++) entry.md5sum[i] = md5[i];
+		entry.size   = size;
+		entry.mtime  = mtime;
+		entry.ctime  = ctime;
+		entry.inode  = inode;
+		entry.device = device;
+		entry.offset = offset;
+		entry.used   = false;
+		_grf_md5_cache[line + key_start] = entry;
+	}
+
+	fclose(f);
+	DEBUG(grf, 2, "Read %d remembered NewGRF checksums", (int)_grf_md5_cache.size());
+}
+
+/** Mark all entries of the NewGRF checksum cache as not looked up; done at the start of each scan. */
+static void ResetGRFMD5CacheUsage()
+{
+	for (GRFMD5Cache::iterator it = _grf_md5_cache.begin(); it != _grf_md5_cache.end(); ++it) {
+		it->second.used = false;
+	}
+}
+
+/**
+ * Write the NewGRF checksum cache to disk when it changed.
+ * Entries that were not looked up during the scan belong to
+ * NewGRFs that are gone, so those are dropped.
+ */
+static void SaveGRFMD5Cache()
+{
+	bool unused = false;
+	for (GRFMD5Cache::const_iterator it = _grf_md5_cache.begin(); it != _grf_md5_cache.end(); ++it) {
+		if (!it->second.used) unused = true;
+	}
+	if (!_grf_md5_cache_dirty && !unused) return;
+	if (_grf_md5_cache_file == NULL) return;
+
+	FILE *f = fopen(_grf_md5_cache_file, "w");
+	if (f == NULL) {
+		DEBUG(grf, 1, "Could not save NewGRF checksum cache to %s", _grf_md5_cache_file);
+		return;
+	}
+
+	fputs(GRF_MD5_CACHE_HEADER, f);
+	for (GRFMD5Cache::iterator it = _grf_md5_cache.begin(); it != _grf_md5_cache.end(); /* nothing */) {
+		if (!it->second.used) {
+			_grf_md5_cache.erase(it++);
+			continue;
+		}
+
+		const GRFMD5CacheEntry &entry = it->second;
+		char md5sum[33];
+		md5sumToString(md5sum, lastof(md5sum), entry.md5sum);
+		fprintf(f, "%s " OTTD_PRINTFHEX64 " " OTTD_PRINTFHEX64 " " OTTD_PRINTFHEX64 " " OTTD_PRINTFHEX64 " " OTTD_PRINTFHEX64 " " OTTD_PRINTFHEX64 " %s\n",
+				md5sum, entry.size, entry.mtime, entry.ctime, entry.inode, entry.device, entry.offset, it->first.c_str());
+		++it;
+	}
+	fclose(f);
+
+	_grf_md5_cache_dirty = false;
+}
+
+/**
+ * Fill the cache entry with the state of the file the NewGRF is read from.
+ * @param entry The entry to fill.
+ * @param f The opened NewGRF file.
+ * @param start Offset of the NewGRF within the file.
+ * @return Whether the state of the file could be determined.
+ */
+static bool GetGRFMD5CacheFileState(GRFMD5CacheEntry *entry, FILE *f, long start)
+{
+	struct stat sb;
+	if (fstat(fileno(f), &sb) != 0) return false;
+
+	entry->size   = sb.st_size;
+#if defined(__APPLE__)
+	entry->mtime  = (uint64)sb.st_mtimespec.tv_sec * 1000000000 + sb.st_mtimespec.tv_nsec;
+	entry->ctime  = (uint64)sb.st_ctimespec.tv_sec * 1000000000 + sb.st_ctimespec.tv_nsec;
+#elif defined(__linux__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+	entry->mtime  = (uint64)sb.st_mtim.tv_sec * 1000000000 + sb.st_mtim.tv_nsec;
+	entry->ctime  = (uint64)sb.st_ctim.tv_sec * 1000000000 + sb.st_ctim.tv_nsec;
+#else
+	entry->mtime  = (uint64)sb.st_mtime * 1000000000;
+	entry->ctime  = (uint64)sb.st_ctime * 1000000000;
+#endif
+	entry->inode  = sb.st_ino;
+	entry->device = sb.st_dev;
+	entry->offset = start;
+	return true;
+}
+
 /**
  * Calculate the MD5 sum for a GRF, and store it in the config.
+ * The result is remembered between runs, so unchanged files need not be read again.
  * @param config GRF to compute.
  * @param subdir The subdirectory to look in.
  * @return MD5 sum was successfully computed
@@ -382,6 +556,28 @@ static bool CalcGRFMD5Sum(GRFConfig *config, Subdirectory subdir)
 	if (f == NULL) return false;
 
 	long start = ftell(f);
+
+	LoadGRFMD5Cache();
+	const char *key = config->filename;
+
+	/* Only the NewGRF directories are cached; the scan visits all of those, so
+	 * entries it did not look up can be dropped when saving the cache. */
+	GRFMD5CacheEntry state;
+	bool has_state = subdir == NEWGRF_DIR && start >= 0 && GetGRFMD5CacheFileState(&state, f, start);
+	if (has_state) {
+		GRFMD5Cache::iterator it = _grf_md5_cache.find(key);
+		if (it != _grf_md5_cache.end()) {
+			GRFMD5CacheEntry &entry = it->second;
+			if (entry.size == state.size && entry.mtime == state.mtime && entry.ctime == state.ctime &&
+					entry.inode == state.inode && entry.device == state.device && entry.offset == state.offset) {
+				entry.used = true;
+				MemCpyT(config->ident.md5sum, entry.md5sum, lengthof(entry.md5sum));
+				FioFCloseFile(f);
+				return true;
+			}
+		}
+	}
+
 	size = min(size, GRFGetSizeOfDataSection(f));
 
 	if (start < 0 || fseek(f, start, SEEK_SET) < 0) {
@@ -398,6 +594,21 @@ static bool CalcGRFMD5Sum(GRFConfig *config, Subdirectory subdir)
 
 	FioFCloseFile(f);
 
+	/* A file changed just now may change again without its timestamps changing;
+	 * only remember it once it has been left alone for a while. */
+	uint64 now = (uint64)time(NULL);
+	if (has_state && max(state.mtime, state.ctime) / 1000000000 + GRF_MD5_CACHE_RACY_SECONDS >= now) {
+		_grf_md5_cache.erase(key);
+		has_state = false;
+	}
+
+	if (has_state) {
+		MemCpyT(state.md5sum, config->ident.md5sum, lengthof(state.md5sum));
+		state.used = true;
+		_grf_md5_cache[key] = state;
+		_grf_md5_cache_dirty = true;
+	}
+
 	return true;
 }
 
@@ -730,6 +941,9 @@ void DoScanNewGRFFiles(void *callback)
 	ClearGRFConfigList(&_all_grfs);
 	TarScanner::DoScan(TarScanner::NEWGRF);
 
+	LoadGRFMD5Cache();
+	ResetGRFMD5CacheUsage();
+
 	DEBUG(grf, 1, "Scanning for NewGRFs");
 	uint num = GRFFileScanner::DoScan();
 
@@ -762,6 +976,8 @@ void DoScanNewGRFFiles(void *callback)
 #endif
 	}
 
+	SaveGRFMD5Cache();
+
 	_modal_progress_work_mutex->EndCritical();
 	_modal_progress_paint_mutex->BeginCritical();
 
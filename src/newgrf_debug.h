@@ -43,5 +43,6 @@ GrfSpecFeature GetGrfSpecFeature(TileIndex tile);
 GrfSpecFeature GetGrfSpecFeature(VehicleType type);
 
 void ShowSpriteAlignerWindow();
+void ShowNewGRFProfileWindow();
 
 #endif /* NEWGRF_DEBUG_H */
@@ -32,6 +32,7 @@
 
 #include "newgrf_airporttiles.h"
 #include "newgrf_debug.h"
+#include "newgrf_engine.h"
 #include "newgrf_object.h"
 #include "newgrf_spritegroup.h"
 #include "newgrf_station.h"
@@ -476,6 +477,17 @@ struct NewGRFInspectWindow : Window {
 			}
 		}
 
+		if (GetFeatureNum(this->window_number) <= GSF_AIRCRAFT) {
+			uint64 lookups = _newgrf_var_cache_stats.hits + _newgrf_var_cache_stats.misses;
+			this->DrawString(r, i++, "Variable cache (all vehicles): " OTTD_PRINTF64 " hits, " OTTD_PRINTF64 " misses (%i%% hit rate)",
+					(int64)_newgrf_var_cache_stats.hits, (int64)_newgrf_var_cache_stats.misses, lookups == 0 ? 0 : (int)(_newgrf_var_cache_stats.hits * 100 / lookups));
+
+			const VehicleSpriteCacheStats &sprites = _vehicle_sprite_cache_stats;
+			uint64 resolutions = sprites.hits + sprites.misses + sprites.uncacheable;
+			this->DrawString(r, i++, "Sprite cache (all vehicles): " OTTD_PRINTF64 " avoided, " OTTD_PRINTF64 " cached, " OTTD_PRINTF64 " uncacheable resolutions (%i%% avoided)",
+					(int64)sprites.hits, (int64)sprites.misses, (int64)sprites.uncacheable, resolutions == 0 ? 0 : (int)(sprites.hits * 100 / resolutions));
+		}
+
 		uint psa_size = nih->GetPSASize(index, this->caller_grfid);
 		const int32 *psa = nih->GetPSAFirstPosition(index, this->caller_grfid);
 		if (psa_size != 0 && psa != NULL) {
@@ -1097,3 +1109,224 @@ void ShowSpriteAlignerWindow()
 {
 	AllocateWindowDescFront<SpriteAlignerWindow>(&_sprite_aligner_desc, 0);
 }
+
+/** Columns of the #NewGRFProfileWindow. */
+enum NewGRFProfileColumn {
+	NGPC_NEWGRF,   ///< Name of the NewGRF.
+	NGPC_FEATURE,  ///< Feature of the resolved objects.
+	NGPC_CALLBACK, ///< Resolved callback.
+	NGPC_CALLS,    ///< Number of resolves.
+	NGPC_NODES,    ///< Number of visited sprite groups.
+	NGPC_TIME,     ///< Total time of the resolves.
+	NGPC_SHARE,    ///< Share of the total time of all resolves.
+	NGPC_PER_TICK, ///< Time of the resolves per game tick.
+	NGPC_END,
+};
+
+/** Window showing the cost of the resolves of each NewGRF, per feature and callback. */
+struct NewGRFProfileWindow : Window {
+	static const int COLUMN_SPACING = 8; ///< Space between the columns.
+
+	NewGRFProfile profile;       ///< Shown entries, the most expensive ones first.
+	uint64 total_time;           ///< Total time of the shown entries.
+	uint column_width[NGPC_END]; ///< Width of the columns, except the NewGRF name which gets the remaining space.
+	Scrollbar *vscroll;
+
+	NewGRFProfileWindow(WindowDesc *desc, WindowNumber wno) : Window(desc)
+	{
+		this->CreateNestedTree();
+		this->vscroll = this->GetScrollbar(WID_NGRFP_SCROLLBAR);
+		this->FinishInitNested(wno);
+		this->OnInvalidateData();
+	}
+
+	virtual void SetStringParameters(int widget) const
+	{
+		if (widget != WID_NGRFP_SUMMARY) return;
+
+		SetDParam(0, _newgrf_profile_ticks);
+		SetDParam(1, this->total_time / 10000);
+		SetDParam(2, 2);
+		SetDParam(3, _newgrf_profile_ticks == 0 ? 0 : this->total_time / 10000 / _newgrf_profile_ticks);
+		SetDParam(4, 2);
+	}
+
+	virtual void UpdateWidgetSize(int widget, Dimension *size, const Dimension &padding, Dimension *fill, Dimension *resize)
+	{
+		switch (widget) {
+			case WID_NGRFP_SUMMARY:
+				SetDParamMaxDigits(0, 8);
+				SetDParamMaxDigits(1, 10);
+				SetDParam(2, 2);
+				SetDParamMaxDigits(3, 6);
+				SetDParam(4, 2);
+				*size = GetStringBoundingBox(STR_NEWGRF_PROFILE_SUMMARY);
+				break;
+
+			case WID_NGRFP_LIST: {
+				/* Numeric columns are sized for the larger of their heading and a big number. */
+				static const char * const samples[] = { "", "industry tiles", "cb 0x000", "9999999999", "99999999999", "999999.99", "100.0%", "9999.999" };
+				assert_compile(lengthof(samples) == NGPC_END);
+				uint width = 0;
+				for (uint i = 0; i < NGPC_END; i++) {
+					SetDParamStr(0, samples[i]);
+					this->column_width[i] = max(GetStringBoundingBox(STR_NEWGRF_PROFILE_COLUMN_NEWGRF + i).width, GetStringBoundingBox(STR_JUST_RAW_STRING).width);
+					width += this->column_width[i] + COLUMN_SPACING;
+				}
+
+				resize->height = FONT_HEIGHT_NORMAL;
+				resize->width = 1;
+				size->width = max(size->width, width + 200 + WD_FRAMERECT_LEFT + WD_FRAMERECT_RIGHT);
+				size->height = 16 * resize->height + WD_FRAMERECT_TOP + WD_FRAMERECT_BOTTOM;
+				break;
+			}
+		}
+	}
+
+	/**
+	 * Get the horizontal bounds of a column.
+	 * @param r Bounds of the list.
+	 * @param column The column.
+	 * @param[out] left Left edge of the column.
+	 * @param[out] right Right edge of the column.
+	 */
+	void GetColumnBounds(const Rect &r, uint column, int *left, int *right) const
+	{
+		int x = r.right - WD_FRAMERECT_RIGHT;
+		for (uint i = NGPC_END - 1; i > column; i--) x -= this->column_width[i] + COLUMN_SPACING;
+		*right = x;
+		*left = column == NGPC_NEWGRF ? r.left + WD_FRAMERECT_LEFT : x - this->column_width[column] + 1;
+
+		if (_current_text_dir == TD_RTL) {
+			int l = r.left + r.right - *right;
+			*right = r.left + r.right - *left;
+			*left = l;
+		}
+	}
+
+	virtual void DrawWidget(const Rect &r, int widget) const
+	{
+		if (widget != WID_NGRFP_LIST) return;
+
+		int y = r.top + WD_FRAMERECT_TOP;
+		for (uint i = 0; i < NGPC_END; i++) {
+			int left, right;
+			this->GetColumnBounds(r, i, &left, &right);
+			DrawString(left, right, y, STR_NEWGRF_PROFILE_COLUMN_NEWGRF + i, TC_FROMSTRING, i < NGPC_CALLS ? SA_LEFT : SA_RIGHT);
+		}
+		y += FONT_HEIGHT_NORMAL;
+
+		int max = min<int>(this->vscroll->GetPosition() + this->vscroll->GetCapacity(), this->profile.Length());
+		for (int n = this->vscroll->GetPosition(); n < max; n++) {
+			const NewGRFProfileEntry &e = this->profile[n];
+
+			char text[NGPC_END][64];
+			strecpy(text[NGPC_NEWGRF], GetNewGRFProfileGRFName(e.grfid), lastof(text[NGPC_NEWGRF]));
+			strecpy(text[NGPC_FEATURE], GetNewGRFProfileFeatureName(e.feature), lastof(text[NGPC_FEATURE]));
+			if (e.callback == CBID_NO_CALLBACK) {
+				strecpy(text[NGPC_CALLBACK], "sprites", lastof(text[NGPC_CALLBACK]));
+			} else {
+				seprintf(text[NGPC_CALLBACK], lastof(text[NGPC_CALLBACK]), "cb 0x%02X", e.callback);
+			}
+			seprintf(text[NGPC_CALLS], lastof(text[NGPC_CALLS]), OTTD_PRINTF64, (int64)e.calls);
+			seprintf(text[NGPC_NODES], lastof(text[NGPC_NODES]), OTTD_PRINTF64, (int64)e.nodes);
+			seprintf(text[NGPC_TIME], lastof(text[NGPC_TIME]), "%.2f", e.time / 1e6);
+			seprintf(text[NGPC_SHARE], lastof(text[NGPC_SHARE]), "%.1f%%", this->total_time == 0 ? 0.0 : e.time * 100.0 / this->total_time);
+			seprintf(text[NGPC_PER_TICK], lastof(text[NGPC_PER_TICK]), "%.3f", _newgrf_profile_ticks == 0 ? 0.0 : e.time / 1e6 / _newgrf_profile_ticks);
+
+			for (uint i = 0; i < NGPC_END; i++) {
+				int left, right;
+				this->GetColumnBounds(r, i, &left, &right);
+				SetDParamStr(0, text[i]);
+				DrawString(left, right, y, STR_JUST_RAW_STRING, TC_BLACK, i < NGPC_CALLS ? SA_LEFT : SA_RIGHT);
+			}
+			y += FONT_HEIGHT_NORMAL;
+		}
+	}
+
+	virtual void OnClick(Point pt, int widget, int click_count)
+	{
+		switch (widget) {
+			case WID_NGRFP_START:
+				if (_newgrf_profiling) {
+					StopNewGRFProfiling();
+				} else {
+					StartNewGRFProfiling();
+				}
+				this->InvalidateData();
+				break;
+
+			case WID_NGRFP_RESET:
+				ResetNewGRFProfile();
+				this->InvalidateData();
+				break;
+		}
+	}
+
+	virtual void OnHundredthTick()
+	{
+		if (_newgrf_profiling) this->InvalidateData();
+	}
+
+	virtual void OnResize()
+	{
+		/* The first line of the list holds the column headings. */
+		this->vscroll->SetCapacityFromWidget(this, WID_NGRFP_LIST, WD_FRAMERECT_TOP + WD_FRAMERECT_BOTTOM + FONT_HEIGHT_NORMAL);
+	}
+
+	/**
+	 * Some data on this window has become invalid.
+	 * @param data Information about the changed data.
+	 * @param gui_scope Whether the call is done from GUI scope. You may not do everything when not in GUI scope. See #InvalidateWindowData() for details.
+	 */
+	virtual void OnInvalidateData(int data = 0, bool gui_scope = true)
+	{
+		if (!gui_scope) return;
+
+		GetNewGRFProfile(this->profile);
+		this->total_time = 0;
+		for (const NewGRFProfileEntry *e = this->profile.Begin(); e != this->profile.End(); e++) this->total_time += e->time;
+
+		this->vscroll->SetCount(this->profile.Length());
+		this->SetWidgetLoweredState(WID_NGRFP_START, _newgrf_profiling);
+	}
+};
+
+static const NWidgetPart _nested_newgrf_profile_widgets[] = {
+	NWidget(NWID_HORIZONTAL),
+		NWidget(WWT_CLOSEBOX, COLOUR_GREY),
+		NWidget(WWT_CAPTION, COLOUR_GREY), SetDataTip(STR_NEWGRF_PROFILE_CAPTION, STR_TOOLTIP_WINDOW_TITLE_DRAG_THIS),
+		NWidget(WWT_SHADEBOX, COLOUR_GREY),
+		NWidget(WWT_DEFSIZEBOX, COLOUR_GREY),
+		NWidget(WWT_STICKYBOX, COLOUR_GREY),
+	EndContainer(),
+	NWidget(NWID_HORIZONTAL),
+		NWidget(WWT_TEXTBTN, COLOUR_GREY, WID_NGRFP_START), SetDataTip(STR_NEWGRF_PROFILE_START, STR_NEWGRF_PROFILE_START_TOOLTIP),
+		NWidget(WWT_PUSHTXTBTN, COLOUR_GREY, WID_NGRFP_RESET), SetDataTip(STR_NEWGRF_PROFILE_RESET, STR_NEWGRF_PROFILE_RESET_TOOLTIP),
+		NWidget(WWT_PANEL, COLOUR_GREY), SetResize(1, 0), SetFill(1, 1),
+			NWidget(WWT_TEXT, COLOUR_GREY, WID_NGRFP_SUMMARY), SetDataTip(STR_NEWGRF_PROFILE_SUMMARY, STR_NULL), SetPadding(2, 2, 2, 2), SetFill(1, 1),
+		EndContainer(),
+	EndContainer(),
+	NWidget(NWID_HORIZONTAL),
+		NWidget(WWT_PANEL, COLOUR_GREY, WID_NGRFP_LIST), SetResize(1, 1), SetFill(1, 1), SetScrollbar(WID_NGRFP_SCROLLBAR), EndContainer(),
+		NWidget(NWID_VERTICAL),
+			NWidget(NWID_VSCROLLBAR, COLOUR_GREY, WID_NGRFP_SCROLLBAR),
+			NWidget(WWT_RESIZEBOX, COLOUR_GREY),
+		EndContainer(),
+	EndContainer(),
+};
+
+static WindowDesc _newgrf_profile_desc(
+	WDP_AUTO, "newgrf_profile", 0, 0,
+	WC_NEWGRF_PROFILE, WC_NONE,
+	0,
+	_nested_newgrf_profile_widgets, lengthof(_nested_newgrf_profile_widgets)
+);
+
+/**
+ * Show the window with the cost of the resolves of each NewGRF.
+ */
+void ShowNewGRFProfileWindow()
+{
+	AllocateWindowDescFront<NewGRFProfileWindow>(&_newgrf_profile_desc, 0);
+}
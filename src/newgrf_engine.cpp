@@ -24,9 +24,16 @@
 #include "company_base.h"
 #include "newgrf_railtype.h"
 #include "ship.h"
+#include "newgrf_debug.h"
+
+#include <map>
+#include <set>
 
 #include "safeguards.h"
 
+NewGRFVariableCacheStats _newgrf_var_cache_stats; ///< Statistics of the caches of vehicle variables.
+VehicleSpriteCacheStats _vehicle_sprite_cache_stats; ///< Statistics of the cache of resolved vehicle sprites.
+
 struct WagonOverride {
 	EngineID *train_id;
 	uint trains;
@@ -394,6 +401,11 @@ static byte MapAircraftMovementAction(const Aircraft *v)
 	}
 }
 
+/* virtual */ GrfSpecFeature VehicleResolverObject::GetFeature() const
+{
+	return GetGrfSpecFeature(Engine::Get(this->self_scope.self_type)->type);
+}
+
 /**
  * Determines the livery of an engine.
  *
@@ -635,10 +647,18 @@ static uint32 VehicleGetVariable(Vehicle *v, const VehicleScopeResolver *object,
 			if (v->type != VEH_TRAIN) return v->GetEngine()->grf_prop.local_id == parameter ? 1 : 0;
 
 			{
-				uint count = 0;
-				for (; v != NULL; v = v->Next()) {
-					if (v->GetEngine()->grf_prop.local_id == parameter) count++;
+				uint32 count;
+				if (v->grf_var_cache.Find(variable, parameter, &count)) {
+					_newgrf_var_cache_stats.hits++;
+					return count;
 				}
+				_newgrf_var_cache_stats.misses++;
+
+				count = 0;
+				for (const Vehicle *u = v; u != NULL; u = u->Next()) {
+					if (u->GetEngine()->grf_prop.local_id == parameter) count++;
+				}
+				v->grf_var_cache.Store(variable, parameter, count);
 				return count;
 			}
 
@@ -993,11 +1013,241 @@ VehicleResolverObject::VehicleResolverObject(EngineID engine_type, const Vehicle
 
 
 
+/** State of a vehicle that an action 2 chain for the sprites of the vehicle may read. */
+enum VehicleSpriteInputs {
+	VSI_NONE        = 0,      ///< The chain only reads constants and the image type.
+	VSI_RANDOM      = 1 << 0, ///< Random bits of the vehicle.
+	VSI_TRIGGERS    = 1 << 1, ///< Waiting random triggers of the vehicle.
+	VSI_LOAD        = 1 << 2, ///< Whether the vehicle is loading, and its capacity and amount of cargo.
+	VSI_CARGO       = 1 << 3, ///< Cargo type and subtype of the vehicle.
+	VSI_UNCACHEABLE = 1 << 6, ///< The chain reads other state, so its result may not be cached.
+};
+DECLARE_ENUM_AS_BIT_SET(VehicleSpriteInputs)
+
+/** Determines the state of a vehicle the sprite chain starting at a group reads. */
+struct VehicleSpriteAnalyser {
+	std::set<const SpriteGroup *> seen; ///< Groups that have been analysed already.
+	VehicleSpriteInputs inputs;         ///< The state of the vehicle read by the analysed groups.
+
+	VehicleSpriteAnalyser() : inputs(VSI_NONE) {}
+
+	/**
+	 * Add the state of the vehicle a variable reads.
+	 * @param variable The variable.
+	 */
+	void AddVariable(byte variable)
+	{
+		switch (variable) {
+			/* The callback and its parameters are fixed for sprites, the others are constant or only depend on the chain itself. */
+			case 0x0C: case 0x10: case 0x18: case 0x1A: case 0x1C: case 0x7E: case 0x7F:
+				break;
+
+			/* The temporary storage is cleared when resolving the root group starts,
+			 * so it only holds what the chain itself stored before reading it. */
+			case 0x7D:
+				break;
+
+			case 0x5F:
+				this->inputs |= VSI_RANDOM | VSI_TRIGGERS;
+				break;
+
+			case 0x47: // Cargo info
+			case 0xB9: // Cargo type
+			case 0xF2: // Cargo subtype
+				this->inputs |= VSI_CARGO;
+				break;
+
+			case 0xBA: case 0xBB: // Capacity
+			case 0xBC: case 0xBD: // Amount of cargo
+				this->inputs |= VSI_LOAD;
+				break;
+
+			default:
+				this->inputs |= VSI_UNCACHEABLE;
+				break;
+		}
+	}
+
+	/**
+	 * Add the state of the vehicle a group and the groups it refers to read.
+	 * @param group The group.
+	 */
+	void AddGroup(const SpriteGroup *group)
+	{
+		if (group == NULL || (this->inputs & VSI_UNCACHEABLE) != 0) return;
+		if (!this->seen.insert(group).second) return;
+
+		switch (group->type) {
+			case SGT_REAL:
+				/* The loaded or loading group is chosen by VehicleResolverObject::ResolveReal. */
+				this->inputs |= VSI_LOAD;
+				break;
+
+			case SGT_DETERMINISTIC: {
+				const DeterministicSpriteGroup *det = (const DeterministicSpriteGroup *)group;
+				if (det->var_scope != VSG_SCOPE_SELF) {
+					this->inputs |= VSI_UNCACHEABLE;
+					return;
+				}
+				for (uint i = 0; i < det->num_adjusts; i++) {
+					const DeterministicSpriteGroupAdjust *adjust = &det->adjusts[i];
+					if (adjust->operation == DSGA_OP_STOP) {
+						this->inputs |= VSI_UNCACHEABLE;
+						return;
+					}
+					this->AddVariable(adjust->variable);
+					if (adjust->variable == 0x7E) this->AddGroup(adjust->subroutine);
+				}
+				for (uint i = 0; i < det->num_ranges; i++) this->AddGroup(det->ranges[i].group);
+				this->AddGroup(det->default_group);
+				break;
+			}
+
+			case SGT_RANDOMIZED: {
+				const RandomizedSpriteGroup *rnd = (const RandomizedSpriteGroup *)group;
+				if (rnd->var_scope != VSG_SCOPE_SELF) {
+					this->inputs |= VSI_UNCACHEABLE;
+					return;
+				}
+				this->inputs |= VSI_RANDOM;
+				for (uint i = 0; i < rnd->num_groups; i++) this->AddGroup(rnd->groups[i]);
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+};
+
+/** Everything the sprites of a vehicle depend on, as far as the chain reads it. */
+struct VehicleSpriteKey {
+	const SpriteGroup *root; ///< Root of the chain.
+	uint stored_count;       ///< Amount of cargo in the vehicle.
+	EngineID engine;         ///< Engine of the vehicle.
+	uint16 capacity;         ///< Cargo capacity of the vehicle.
+	byte image_type;         ///< Where the vehicle is drawn.
+	byte random_bits;        ///< Random bits of the vehicle.
+	byte triggers;           ///< Waiting random triggers of the vehicle.
+	CargoID cargo_type;      ///< Cargo type of the vehicle.
+	byte cargo_subtype;      ///< Cargo subtype of the vehicle.
+	byte flags;              ///< Bit 0: there is no vehicle; bit 1: the vehicle is not loading.
+};
+
+/** Resolved sprites of a vehicle, before applying the direction. */
+struct VehicleSpriteCacheEntry {
+	VehicleSpriteKey key;  ///< The state the sprites were resolved for; the root is \c NULL when the entry is unused.
+	SpriteID sprite[4];    ///< First sprite of each sprite set of the stack.
+	byte num_sprites[4];   ///< Number of sprites in each sprite set of the stack.
+	PaletteID pal[4];      ///< Recolouring of each layer of the stack.
+	uint count;            ///< Number of layers of the stack.
+};
+
+static const uint VEHICLE_SPRITE_CACHE_SIZE = 1024; ///< Number of entries of the vehicle sprite cache; must be a power of two.
+static VehicleSpriteCacheEntry _vehicle_sprite_cache[VEHICLE_SPRITE_CACHE_SIZE]; ///< Resolved vehicle sprites, indexed by a hash of their key.
+static std::map<const SpriteGroup *, VehicleSpriteInputs> _vehicle_sprite_inputs;  ///< State of the vehicle each analysed root group reads.
+
+/** Forget all resolved vehicle sprites and analyses, as the NewGRFs are reloaded. */
+void ResetVehicleSpriteCache()
+{
+	MemSetT(_vehicle_sprite_cache, 0, lengthof(_vehicle_sprite_cache));
+	_vehicle_sprite_inputs.clear();
+}
+
+/**
+ * Get the state of a vehicle the sprite chain of a root group reads.
+ * @param root The root group.
+ * @return The state of the vehicle, or #VSI_UNCACHEABLE.
+ */
+static VehicleSpriteInputs GetVehicleSpriteInputs(const SpriteGroup *root)
+{
+	std::map<const SpriteGroup *, VehicleSpriteInputs>::const_iterator it = _vehicle_sprite_inputs.find(root);
+	if (it != _vehicle_sprite_inputs.end()) return it->second;
+
+	VehicleSpriteAnalyser analyser;
+	analyser.AddGroup(root);
+	_vehicle_sprite_inputs[root] = analyser.inputs;
+	return analyser.inputs;
+}
+
+/**
+ * Get the cache entry for the sprites of a vehicle.
+ * @param key The state of the vehicle.
+ * @return The entry the key maps to; it may hold the sprites of another key.
+ */
+static VehicleSpriteCacheEntry *GetVehicleSpriteCacheEntry(const VehicleSpriteKey &key)
+{
+	uint32 hash = (uint32)(size_t)key.root >> 4;
+	hash = hash * 31 + key.engine;
+	hash = hash * 31 + key.image_type;
+	hash = hash * 31 + key.random_bits;
+	hash = hash * 31 + key.triggers;
+	hash = hash * 31 + key.stored_count;
+	hash = hash * 31 + key.capacity;
+	hash = hash * 31 + key.cargo_type;
+	hash = hash * 31 + key.cargo_subtype;
+	hash = hash * 31 + key.flags;
+	hash ^= hash >> 16;
+	return &_vehicle_sprite_cache[hash & (VEHICLE_SPRITE_CACHE_SIZE - 1)];
+}
+
+/**
+ * Get the sprites of a vehicle.
+ * The groups the chain resolves to are cached, keyed on the state of the vehicle the chain
+ * reads, so identical vehicles, like the wagons of long trains, are only resolved once.
+ * @param engine Engine of the vehicle.
+ * @param v The vehicle, or \c NULL when drawing the engine in a list.
+ * @param direction Direction the vehicle is facing.
+ * @param image_type Where the vehicle is drawn.
+ * @param [out] result The sprites.
+ */
 void GetCustomEngineSprite(EngineID engine, const Vehicle *v, Direction direction, EngineImageType image_type, VehicleSpriteSeq *result)
 {
 	VehicleResolverObject object(engine, v, VehicleResolverObject::WO_CACHED, false, CBID_NO_CALLBACK);
 	result->Clear();
 
+	VehicleSpriteCacheEntry *entry = NULL;
+	VehicleSpriteKey key;
+	VehicleSpriteInputs inputs = object.root_spritegroup == NULL ? VSI_UNCACHEABLE : GetVehicleSpriteInputs(object.root_spritegroup);
+	if (inputs & VSI_UNCACHEABLE) {
+		_vehicle_sprite_cache_stats.uncacheable++;
+	} else {
+		/* Padding takes part in the comparison, so clear it. */
+		MemSetT(&key, 0);
+		key.root = object.root_spritegroup;
+		key.engine = engine;
+		key.image_type = image_type;
+		if (v == NULL) {
+			SetBit(key.flags, 0);
+		} else {
+			if (inputs & VSI_RANDOM) key.random_bits = v->random_bits;
+			if (inputs & VSI_TRIGGERS) key.triggers = v->waiting_triggers;
+			if (inputs & VSI_CARGO) {
+				key.cargo_type = v->cargo_type;
+				key.cargo_subtype = v->cargo_subtype;
+			}
+			if (inputs & VSI_LOAD) {
+				key.stored_count = v->cargo.StoredCount();
+				key.capacity = v->cargo_cap;
+				if (!v->First()->current_order.IsType(OT_LOADING)) SetBit(key.flags, 1);
+			}
+		}
+
+		entry = GetVehicleSpriteCacheEntry(key);
+		if (MemCmpT(&entry->key, &key) == 0) {
+			_vehicle_sprite_cache_stats.hits++;
+			for (uint i = 0; i < entry->count; i++) {
+				result->seq[i].sprite = entry->sprite[i] + (direction % entry->num_sprites[i]);
+				result->seq[i].pal    = entry->pal[i];
+			}
+			result->count = entry->count;
+			return;
+		}
+		_vehicle_sprite_cache_stats.misses++;
+		entry->key = key;
+		entry->count = 0;
+	}
+
 	bool sprite_stack = HasBit(EngInfo(engine)->misc_flags, EF_SPRITE_STACK);
 	uint max_stack = sprite_stack ? lengthof(result->seq) : 1;
 	for (uint stack = 0; stack < max_stack; ++stack) {
@@ -1006,6 +1256,12 @@ void GetCustomEngineSprite(EngineID engine, const Vehicle *v, Direction directio
 		const SpriteGroup *group = object.Resolve();
 		uint32 reg100 = sprite_stack ? GetRegister(0x100) : 0;
 		if (group != NULL && group->GetNumResults() != 0) {
+			if (entry != NULL) {
+				entry->sprite[result->count]      = group->GetResult();
+				entry->num_sprites[result->count] = group->GetNumResults();
+				entry->pal[result->count]         = GB(reg100, 0, 16);
+				entry->count++;
+			}
 			result->seq[result->count].sprite = group->GetResult() + (direction % group->GetNumResults());
 			result->seq[result->count].pal    = GB(reg100, 0, 16); // zero means default recolouring
 			result->count++;
@@ -1070,6 +1326,35 @@ uint16 GetVehicleCallback(CallbackID callback, uint32 param1, uint32 param2, Eng
 	return object.ResolveCallback();
 }
 
+/**
+ * Evaluate the 32 day callback for a vehicle.
+ * Engines whose chains give the same result for every vehicle, like most of those
+ * that do not use the callback at all, are only analysed once instead of resolved.
+ * @param v The vehicle to evaluate the callback for.
+ * @return The callback result.
+ */
+uint16 GetVehicle32DayCallback(const Vehicle *v)
+{
+	Engine *e = Engine::Get(v->engine_type);
+	if (e->callback_32day_result == CALLBACK_UNKNOWN) {
+		/* Any of the cargo specific groups and wagon overrides may be used for a vehicle. */
+		SmallVector<const SpriteGroup *, 16> roots;
+		*roots.Append() = e->grf_prop.spritegroup[CT_DEFAULT];
+		for (uint i = 0; i < lengthof(e->grf_prop.spritegroup); i++) {
+			if (e->grf_prop.spritegroup[i] != NULL) roots.Include(e->grf_prop.spritegroup[i]);
+		}
+		for (uint i = 0; i < e->overrides_count; i++) roots.Include(e->overrides[i].group);
+		e->callback_32day_result = GetConstantCallbackResult(roots.Begin(), roots.Length(), CBID_VEHICLE_32DAY_CALLBACK);
+	}
+
+	if (e->callback_32day_result == CALLBACK_VARIES) return GetVehicleCallback(CBID_VEHICLE_32DAY_CALLBACK, 0, 0, v->engine_type, v);
+
+	/* Resolving starts with cleared registers, and constant chains do not store any. */
+	extern TemporaryStorageArray<int32, 0x110> _temp_store;
+	_temp_store.ClearChanges();
+	return e->callback_32day_result;
+}
+
 /**
  * Evaluate a newgrf callback for vehicles with a different vehicle for parent scope.
  * @param callback The callback to evaluate
@@ -67,6 +67,8 @@ struct VehicleResolverObject : public ResolverObject {
 	/* virtual */ ScopeResolver *GetScope(VarSpriteGroupScope scope = VSG_SCOPE_SELF, byte relative = 0);
 
 	/* virtual */ const SpriteGroup *ResolveReal(const RealSpriteGroup *group) const;
+
+	/* virtual */ GrfSpecFeature GetFeature() const;
 };
 
 static const uint TRAININFO_DEFAULT_VEHICLE_WIDTH   = 29;
@@ -93,7 +95,27 @@ struct GRFFile;
 
 void SetEngineGRF(EngineID engine, const struct GRFFile *file);
 
+/** Statistics of the caches of vehicle variables, see #NewGRFVariableCache. */
+struct NewGRFVariableCacheStats {
+	uint64 hits;   ///< Number of variables found in a cache.
+	uint64 misses; ///< Number of variables that had to be computed and were then cached.
+};
+
+extern NewGRFVariableCacheStats _newgrf_var_cache_stats;
+
+/** Statistics of the cache of resolved vehicle sprites, see #GetCustomEngineSprite. */
+struct VehicleSpriteCacheStats {
+	uint64 hits;        ///< Number of sprite resolutions that were avoided.
+	uint64 misses;      ///< Number of sprite resolutions that were done and then cached.
+	uint64 uncacheable; ///< Number of sprite resolutions for chains reading state that is not part of the cache key.
+};
+
+extern VehicleSpriteCacheStats _vehicle_sprite_cache_stats;
+
+void ResetVehicleSpriteCache();
+
 uint16 GetVehicleCallback(CallbackID callback, uint32 param1, uint32 param2, EngineID engine, const Vehicle *v);
+uint16 GetVehicle32DayCallback(const Vehicle *v);
 uint16 GetVehicleCallbackParent(CallbackID callback, uint32 param1, uint32 param2, EngineID engine, const Vehicle *v, const Vehicle *parent);
 bool UsesWagonOverride(const Vehicle *v);
 
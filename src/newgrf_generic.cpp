@@ -52,6 +52,7 @@ private:
 /** Resolver object for generic objects/properties. */
 struct GenericResolverObject : public ResolverObject {
 	GenericScopeResolver generic_scope;
+	GrfSpecFeature feature; ///< Feature of the callback list being resolved.
 
 	GenericResolverObject(bool ai_callback, CallbackID callback = CBID_NO_CALLBACK);
 
@@ -64,6 +65,8 @@ struct GenericResolverObject : public ResolverObject {
 	}
 
 	/* virtual */ const SpriteGroup *ResolveReal(const RealSpriteGroup *group) const;
+
+	/* virtual */ GrfSpecFeature GetFeature() const { return this->feature; }
 };
 
 struct GenericCallback {
@@ -150,7 +153,7 @@ void AddGenericCallback(uint8 feature, const GRFFile *file, const SpriteGroup *g
  * @param ai_callback Callback comes from the AI.
  * @param callback Callback ID.
  */
-GenericResolverObject::GenericResolverObject(bool ai_callback, CallbackID callback) : ResolverObject(NULL, callback), generic_scope(*this, ai_callback)
+GenericResolverObject::GenericResolverObject(bool ai_callback, CallbackID callback) : ResolverObject(NULL, callback), generic_scope(*this, ai_callback), feature(GSF_INVALID)
 {
 }
 
@@ -166,9 +169,10 @@ GenericResolverObject::GenericResolverObject(bool ai_callback, CallbackID callba
  *                   May be NULL if not required.
  * @return callback value if successful or CALLBACK_FAILED
  */
-static uint16 GetGenericCallbackResult(uint8 feature, ResolverObject &object, uint32 param1_grfv7, uint32 param1_grfv8, const GRFFile **file)
+static uint16 GetGenericCallbackResult(uint8 feature, GenericResolverObject &object, uint32 param1_grfv7, uint32 param1_grfv8, const GRFFile **file)
 {
 	assert(feature < lengthof(_gcl));
+	object.feature = (GrfSpecFeature)feature;
 
 	/* Test each feature callback sprite group. */
 	for (GenericCallbackList::const_iterator it = _gcl[feature].begin(); it != _gcl[feature].end(); ++it) {
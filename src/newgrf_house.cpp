@@ -28,6 +28,7 @@
 
 static BuildingCounts<uint32> _building_counts;
 static HouseClassMapping _class_mapping[HOUSE_CLASS_MAX];
+static ConstantCallbackResults<NUM_HOUSES> _house_produce_cargo_results; ///< Results of the cargo production callback for house types where it is constant.
 
 HouseOverrideManager _house_mngr(NEW_HOUSE_OFFSET, NUM_HOUSES, INVALID_HOUSE_ID);
 
@@ -418,6 +419,24 @@ uint16 GetHouseCallback(CallbackID callback, uint32 param1, uint32 param2, House
 	return object.ResolveCallback();
 }
 
+/**
+ * Evaluate the cargo production callback of a house.
+ * House types whose chain gives the same result for every house are only analysed once instead of resolved.
+ * @param index Index of the cargo in the production loop.
+ * @param random Random bits passed to the callback.
+ * @param house_id The house type.
+ * @param town The town the house belongs to.
+ * @param tile The tile of the house.
+ * @return The callback result.
+ */
+uint16 GetHouseProduceCargoCallback(uint index, uint32 random, HouseID house_id, Town *town, TileIndex tile)
+{
+	uint32 result = _house_produce_cargo_results.Get(house_id, HouseSpec::Get(house_id)->grf_prop.spritegroup[0], CBID_HOUSE_PRODUCE_CARGO);
+	if (result != CALLBACK_VARIES) return result;
+
+	return GetHouseCallback(CBID_HOUSE_PRODUCE_CARGO, index, random, house_id, town, tile);
+}
+
 static void DrawTileLayout(const TileInfo *ti, const TileLayoutSpriteGroup *group, byte stage, HouseID house_id)
 {
 	const DrawTileSprites *dts = group->ProcessRegisters(&stage);
@@ -445,6 +464,41 @@ static void DrawTileLayout(const TileInfo *ti, const TileLayoutSpriteGroup *grou
 	DrawNewGRFTileSeq(ti, dts, TO_HOUSES, stage, palette);
 }
 
+/** Groups the house tiles most recently drawn resolved to. */
+static TileDrawCache<NUM_HOUSES> _house_draw_cache;
+
+/** House variables that only depend on the state of the house tile. */
+static const TileDrawVariable _house_draw_variables[] = {
+	{0x40, TDI_STAGE},
+	{0x41, TDI_AGE},
+	{0x46, TDI_ANIMATION},
+	{0x47, TDI_NONE},
+};
+
+/** Forget the groups the house tiles resolved to and the constant callback results, as the NewGRFs are reloaded. */
+void ResetHouseCaches()
+{
+	_house_draw_cache.Clear();
+	_house_produce_cargo_results.Clear();
+}
+
+/**
+ * Get the state of a house tile its drawing chain depends on.
+ * @param tile The tile.
+ * @param inputs The parts of the state the chain reads.
+ * @return The state packed into a single value.
+ */
+static uint64 GetHouseDrawKey(TileIndex tile, TileDrawInputs inputs)
+{
+	uint64 key = 0;
+	if (inputs & TDI_STAGE)     key |= GetHouseBuildingStage(tile);
+	if (inputs & TDI_AGE)       key |= (uint64)GetHouseAge(tile) << 8;
+	if (inputs & TDI_ANIMATION) key |= (uint64)GetAnimationFrame(tile) << 16;
+	if (inputs & TDI_RANDOM)    key |= (uint64)GetHouseRandomBits(tile) << 24;
+	if (inputs & TDI_TRIGGERS)  key |= (uint64)GetHouseTriggers(tile) << 32;
+	return key;
+}
+
 void DrawNewHouseTile(TileInfo *ti, HouseID house_id)
 {
 	const HouseSpec *hs = HouseSpec::Get(house_id);
@@ -460,9 +514,20 @@ void DrawNewHouseTile(TileInfo *ti, HouseID house_id)
 		if (draw_old_one) DrawFoundation(ti, FOUNDATION_LEVELED);
 	}
 
-	HouseResolverObject object(house_id, ti->tile, Town::GetByTile(ti->tile));
+	const SpriteGroup *group;
+	TileDrawInputs inputs = _house_draw_cache.GetInputs(house_id, hs->grf_prop.spritegroup[0], _house_draw_variables, lengthof(_house_draw_variables));
+	if (inputs & TDI_UNCACHEABLE) {
+		HouseResolverObject object(house_id, ti->tile, Town::GetByTile(ti->tile));
+		group = object.Resolve();
+	} else {
+		uint64 key = GetHouseDrawKey(ti->tile, inputs);
+		if (!_house_draw_cache.Lookup(ti->tile, house_id, key, &group)) {
+			HouseResolverObject object(house_id, ti->tile, Town::GetByTile(ti->tile));
+			group = object.Resolve();
+			_house_draw_cache.Store(ti->tile, house_id, key, group);
+		}
+	}
 
-	const SpriteGroup *group = object.Resolve();
 	if (group != NULL && group->type == SGT_TILELAYOUT) {
 		/* Limit the building stage to the number of stages supplied. */
 		const TileLayoutSpriteGroup *tlgroup = (const TileLayoutSpriteGroup *)group;
@@ -358,8 +358,8 @@ static uint32 GetCountAndDistanceOfClosestInstance(byte param_setID, byte layout
 		case 0xA7: return this->industry->founder;
 		case 0xA8: return this->industry->random_colour;
 		case 0xA9: return Clamp(this->industry->last_prod_year - ORIGINAL_BASE_YEAR, 0, 255);
-		case 0xAA: return this->industry->counter;
-		case 0xAB: return GB(this->industry->counter, 8, 8);
+		case 0xAA: return this->industry->GetCounter();
+		case 0xAB: return GB(this->industry->GetCounter(), 8, 8);
 		case 0xAC: return this->industry->was_cargo_delivered;
 
 		case 0xB0: return Clamp(this->industry->construction_date - DAYS_TILL_ORIGINAL_BASE_YEAR, 0, 65535); // Date when built since 1920 (in days)
@@ -473,6 +473,33 @@ uint16 GetIndustryCallback(CallbackID callback, uint32 param1, uint32 param2, In
 	return object.ResolveCallback();
 }
 
+/** Results of the random and monthly production change callbacks for industry types where they are constant. */
+static ConstantCallbackResults<NUM_INDUSTRYTYPES> _industry_production_change_results[2];
+
+/** Forget the constant callback results of the industry types, as the NewGRFs are reloaded. */
+void ResetIndustryCallbackResults()
+{
+	_industry_production_change_results[0].Clear();
+	_industry_production_change_results[1].Clear();
+}
+
+/**
+ * Evaluate the (monthly) production change callback of an industry.
+ * Industry types whose chain gives the same result for every industry are only analysed once instead of resolved.
+ * @param monthly Whether the monthly or the random production change is evaluated.
+ * @param random Random bits passed to the callback.
+ * @param industry The industry.
+ * @return The callback result.
+ */
+uint16 GetIndustryProductionChangeCallback(bool monthly, uint32 random, Industry *industry)
+{
+	CallbackID callback = monthly ? CBID_INDUSTRY_MONTHLYPROD_CHANGE : CBID_INDUSTRY_PRODUCTION_CHANGE;
+	uint32 result = _industry_production_change_results[monthly].Get(industry->type, GetIndustrySpec(industry->type)->grf_prop.spritegroup[0], callback);
+	if (result != CALLBACK_VARIES) return result;
+
+	return GetIndustryCallback(callback, 0, random, industry, industry->type, industry->location.tile);
+}
+
 /**
  * Check that the industry callback allows creation of the industry.
  * @param tile %Tile to build the industry.
@@ -65,6 +65,8 @@ struct IndustriesResolverObject : public ResolverObject {
 				return ResolverObject::GetScope(scope, relative);
 		}
 	}
+
+	/* virtual */ GrfSpecFeature GetFeature() const { return GSF_INDUSTRIES; }
 };
 
 /** When should the industry(tile) be triggered for random bits? */
@@ -87,6 +89,8 @@ enum IndustryAvailabilityCallType {
 
 /* in newgrf_industry.cpp */
 uint16 GetIndustryCallback(CallbackID callback, uint32 param1, uint32 param2, Industry *industry, IndustryType type, TileIndex tile);
+uint16 GetIndustryProductionChangeCallback(bool monthly, uint32 random, Industry *industry);
+void ResetIndustryCallbackResults();
 uint32 GetIndustryIDAtOffset(TileIndex new_tile, const Industry *i, uint32 cur_grfid);
 void IndustryProductionCallback(Industry *ind, int reason);
 CommandCost CheckIfCallBackAllowsCreation(TileIndex tile, IndustryType type, uint layout, uint32 seed, uint16 initial_random_bits, Owner founder, IndustryAvailabilityCallType creation_type);
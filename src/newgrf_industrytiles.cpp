@@ -178,6 +178,39 @@ uint16 GetIndustryTileCallback(CallbackID callback, uint32 param1, uint32 param2
 	return object.ResolveCallback();
 }
 
+/** Groups the industry tiles most recently drawn resolved to. */
+static TileDrawCache<NUM_INDUSTRYTILES> _industry_tile_draw_cache;
+
+/** Industry tile variables that only depend on the state of the industry tile. */
+static const TileDrawVariable _industry_tile_draw_variables[] = {
+	{0x40, TDI_STAGE},
+	{0x43, TDI_NONE}, // The location of the industry is part of the key.
+	{0x44, TDI_ANIMATION},
+};
+
+/** Forget the groups the industry tiles resolved to, as the NewGRFs are reloaded. */
+void ResetIndustryTileDrawCache()
+{
+	_industry_tile_draw_cache.Clear();
+}
+
+/**
+ * Get the state of an industry tile its drawing chain depends on.
+ * @param tile The tile.
+ * @param i The industry the tile belongs to.
+ * @param inputs The parts of the state the chain reads.
+ * @return The state packed into a single value.
+ */
+static uint64 GetIndustryTileDrawKey(TileIndex tile, const Industry *i, TileDrawInputs inputs)
+{
+	uint64 key = (uint64)i->location.tile << 32;
+	if (inputs & TDI_STAGE)     key |= GetIndustryConstructionStage(tile);
+	if (inputs & TDI_ANIMATION) key |= GetAnimationFrame(tile) << 8;
+	if (inputs & TDI_RANDOM)    key |= GetIndustryRandomBits(tile) << 16;
+	if (inputs & TDI_TRIGGERS)  key |= GetIndustryTriggers(tile) << 24;
+	return key;
+}
+
 bool DrawNewIndustryTile(TileInfo *ti, Industry *i, IndustryGfx gfx, const IndustryTileSpec *inds)
 {
 	if (ti->tileh != SLOPE_FLAT) {
@@ -191,9 +224,20 @@ bool DrawNewIndustryTile(TileInfo *ti, Industry *i, IndustryGfx gfx, const Indus
 		if (draw_old_one) DrawFoundation(ti, FOUNDATION_LEVELED);
 	}
 
-	IndustryTileResolverObject object(gfx, ti->tile, i);
+	const SpriteGroup *group;
+	TileDrawInputs inputs = _industry_tile_draw_cache.GetInputs(gfx, inds->grf_prop.spritegroup[0], _industry_tile_draw_variables, lengthof(_industry_tile_draw_variables));
+	if (inputs & TDI_UNCACHEABLE) {
+		IndustryTileResolverObject object(gfx, ti->tile, i);
+		group = object.Resolve();
+	} else {
+		uint64 key = GetIndustryTileDrawKey(ti->tile, i, inputs);
+		if (!_industry_tile_draw_cache.Lookup(ti->tile, gfx, key, &group)) {
+			IndustryTileResolverObject object(gfx, ti->tile, i);
+			group = object.Resolve();
+			_industry_tile_draw_cache.Store(ti->tile, gfx, key, group);
+		}
+	}
 
-	const SpriteGroup *group = object.Resolve();
 	if (group == NULL || group->type != SGT_TILELAYOUT) return false;
 
 	/* Limit the building stage to the number of stages supplied. */
@@ -0,0 +1,257 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file newgrf_profiling.cpp Profiling of the time NewGRFs take to resolve sprites and callbacks. */
+
+#include "stdafx.h"
+#include <map>
+#include "newgrf_profiling.h"
+#include "newgrf_spritegroup.h"
+#include "newgrf_config.h"
+#include "core/sort_func.hpp"
+#include "console_func.h"
+#include "console_type.h"
+#include "string_func.h"
+#include "framerate_type.h"
+#include "cpu.h"
+
+#include "safeguards.h"
+
+bool _newgrf_profiling = false;           ///< Whether resolves are being profiled.
+uint64 _sprite_group_resolve_count = 0;   ///< Number of sprite groups visited by all resolves so far, including cached resolves.
+uint64 _newgrf_profile_ticks = 0;         ///< Number of game ticks run while profiling.
+
+/** Profile entries, keyed on GRF ID, feature and callback as packed by #GetProfileKey. */
+typedef std::map<uint64, NewGRFProfileEntry> NewGRFProfileMap;
+static NewGRFProfileMap _newgrf_profile;
+
+static uint64 _nested_cycles; ///< Cycles spent in resolves nested in the current one.
+static uint64 _nested_nodes;  ///< Sprite groups visited by resolves nested in the current one.
+
+/*
+ * Single resolves are too short for the performance timer, so they are timed
+ * in processor cycles like TIC/TOC do. The cycles are converted to time using
+ * the cycles and the time that passed while profiling.
+ */
+static uint64 _profile_cycles;                ///< Cycles passed while profiling, excluding the current period.
+static TimingMeasurement _profile_time;       ///< Microseconds passed while profiling, excluding the current period.
+static uint64 _profile_start_cycles;          ///< Cycle counter at the start of the current profiling period.
+static TimingMeasurement _profile_start_time; ///< Performance timer at the start of the current profiling period.
+
+/**
+ * Get the key of the profile entry for a resolve.
+ * @param grfid GRF ID of the resolved object.
+ * @param feature Feature of the resolved object.
+ * @param callback Resolved callback.
+ * @return The key.
+ */
+static inline uint64 GetProfileKey(uint32 grfid, GrfSpecFeature feature, CallbackID callback)
+{
+	return (uint64)grfid << 32 | feature << 16 | callback;
+}
+
+/**
+ * Resolve the root sprite group of an object and account the time it took,
+ * and the number of sprite groups it visited, to the object's NewGRF.
+ * Resolves of other objects nested in this one, e.g. for callbacks queried
+ * by variables, are accounted to their own NewGRF only.
+ * @param object The object to resolve.
+ * @return The resolved group.
+ */
+const SpriteGroup *ResolveProfiled(ResolverObject &object)
+{
+	uint64 outer_cycles = _nested_cycles;
+	uint64 outer_nodes = _nested_nodes;
+	_nested_cycles = 0;
+	_nested_nodes = 0;
+
+	uint64 start_nodes = _sprite_group_resolve_count;
+	uint64 start_cycles = ottd_rdtsc();
+	const SpriteGroup *result = SpriteGroup::Resolve(object.root_spritegroup, object);
+	uint64 cycles = ottd_rdtsc() - start_cycles;
+	uint64 nodes = _sprite_group_resolve_count - start_nodes;
+
+	uint32 grfid = object.grffile != NULL ? object.grffile->grfid : 0;
+	GrfSpecFeature feature = object.GetFeature();
+	NewGRFProfileEntry &entry = _newgrf_profile[GetProfileKey(grfid, feature, object.callback)];
+	if (entry.calls == 0) {
+		entry.grfid = grfid;
+		entry.feature = feature;
+		entry.callback = object.callback;
+	}
+	entry.calls++;
+	entry.nodes += nodes - _nested_nodes;
+	entry.cycles += cycles - min(cycles, _nested_cycles);
+
+	_nested_cycles = outer_cycles + cycles;
+	_nested_nodes = outer_nodes + nodes;
+	return result;
+}
+
+/** Start profiling resolves, adding to the already collected data. */
+void StartNewGRFProfiling()
+{
+	if (_newgrf_profiling) return;
+
+	_newgrf_profiling = true;
+	_profile_start_cycles = ottd_rdtsc();
+	_profile_start_time = GetPerformanceTimer();
+}
+
+/** Stop profiling resolves; the collected data is kept. */
+void StopNewGRFProfiling()
+{
+	if (!_newgrf_profiling) return;
+
+	_newgrf_profiling = false;
+	_profile_cycles += ottd_rdtsc() - _profile_start_cycles;
+	_profile_time += GetPerformanceTimer() - _profile_start_time;
+}
+
+/** Remove all collected profiling data. */
+void ResetNewGRFProfile()
+{
+	_newgrf_profile.clear();
+	_newgrf_profile_ticks = 0;
+	_profile_cycles = 0;
+	_profile_time = 0;
+	_profile_start_cycles = ottd_rdtsc();
+	_profile_start_time = GetPerformanceTimer();
+}
+
+/**
+ * Get the number of nanoseconds a processor cycle took while profiling.
+ * @return The duration of a cycle, or 0 when the cycles cannot be counted.
+ */
+static double GetNanosecondsPerCycle()
+{
+	uint64 cycles = _profile_cycles;
+	TimingMeasurement time = _profile_time;
+	if (_newgrf_profiling) {
+		cycles += ottd_rdtsc() - _profile_start_cycles;
+		time += GetPerformanceTimer() - _profile_start_time;
+	}
+	return cycles == 0 ? 0.0 : time * 1000.0 / cycles;
+}
+
+/** Sort profile entries on descending time. */
+static int CDECL ProfileEntrySorter(const NewGRFProfileEntry *a, const NewGRFProfileEntry *b)
+{
+	if (a->cycles != b->cycles) return a->cycles > b->cycles ? -1 : 1;
+	return a->calls > b->calls ? -1 : (a->calls < b->calls ? 1 : 0);
+}
+
+/**
+ * Get the collected profiling data.
+ * @param[out] profile The entries, the most expensive ones first.
+ */
+void GetNewGRFProfile(NewGRFProfile &profile)
+{
+	double ns_per_cycle = GetNanosecondsPerCycle();
+
+	profile.Clear();
+	for (NewGRFProfileMap::const_iterator it = _newgrf_profile.begin(); it != _newgrf_profile.end(); ++it) {
+		NewGRFProfileEntry *entry = profile.Append();
+		*entry = it->second;
+		entry->time = (uint64)(entry->cycles * ns_per_cycle);
+	}
+	QSortT(profile.Begin(), profile.Length(), &ProfileEntrySorter);
+}
+
+/**
+ * Get a short name of a feature for the profile output.
+ * @param feature The feature.
+ * @return The name.
+ */
+const char *GetNewGRFProfileFeatureName(GrfSpecFeature feature)
+{
+	static const char * const names[] = {
+		"trains", "road vehicles", "ships", "aircraft", "stations", "canals", "bridges", "houses", "global",
+		"industry tiles", "industries", "cargoes", "sounds", "airports", "signals", "objects", "rail types", "airport tiles",
+		"towns",
+	};
+	assert_compile(lengthof(names) == GSF_FAKE_END);
+	return feature < GSF_FAKE_END ? names[feature] : "other";
+}
+
+/**
+ * Get the name of a profiled NewGRF for the profile output.
+ * @param grfid GRF ID of the NewGRF.
+ * @return The name, or a placeholder when the NewGRF is not active.
+ */
+const char *GetNewGRFProfileGRFName(uint32 grfid)
+{
+	if (grfid == 0) return "(none)";
+	const GRFConfig *c = GetGRFConfig(grfid);
+	return c != NULL ? c->GetName() : "(unknown)";
+}
+
+/**
+ * Write the collected profiling data to a CSV file.
+ * @param filename File to write to.
+ * @return Whether the file could be written.
+ */
+bool ExportNewGRFProfile(const char *filename)
+{
+	FILE *f = fopen(filename, "w");
+	if (f == NULL) return false;
+
+	NewGRFProfile profile;
+	GetNewGRFProfile(profile);
+
+	fprintf(f, "grfid,name,feature,callback,calls,nodes,time_us,ticks\n");
+	for (const NewGRFProfileEntry *e = profile.Begin(); e != profile.End(); e++) {
+		/* Quotes within the name are doubled, as CSV requires. */
+		char name[256];
+		char *p = name;
+		for (const char *s = GetNewGRFProfileGRFName(e->grfid); *s != '\0' && p < lastof(name) - 1; s++) {
+			if (*s == '"') *p++ = '"';
+			*p++ = *s;
+		}
+		*p = '\0';
+
+		fprintf(f, "%08X,\"%s\",%s,0x%02X," OTTD_PRINTF64 "," OTTD_PRINTF64 "," OTTD_PRINTF64 "," OTTD_PRINTF64 "\n",
+				BSWAP32(e->grfid), name, GetNewGRFProfileFeatureName(e->feature), e->callback,
+				(int64)e->calls, (int64)e->nodes, (int64)(e->time / 1000), (int64)_newgrf_profile_ticks);
+	}
+
+	bool ok = ferror(f) == 0;
+	fclose(f);
+	return ok;
+}
+
+/** Print the collected profiling data to the console, per NewGRF, feature and callback. */
+void ConPrintNewGRFProfile()
+{
+	NewGRFProfile profile;
+	GetNewGRFProfile(profile);
+
+	IConsolePrintF(TC_SILVER, "NewGRF profiling is %s; " OTTD_PRINTF64 " game ticks profiled", _newgrf_profiling ? "running" : "stopped", (int64)_newgrf_profile_ticks);
+	if (profile.Length() == 0) {
+		IConsoleWarning("No resolves have been profiled yet");
+		return;
+	}
+
+	uint64 total = 0;
+	for (const NewGRFProfileEntry *e = profile.Begin(); e != profile.End(); e++) total += e->time;
+
+	for (const NewGRFProfileEntry *e = profile.Begin(); e != profile.End(); e++) {
+		char callback[16];
+		if (e->callback == CBID_NO_CALLBACK) {
+			strecpy(callback, "sprites", lastof(callback));
+		} else {
+			seprintf(callback, lastof(callback), "cb 0x%02X", e->callback);
+		}
+
+		IConsolePrintF(TC_LIGHT_BLUE, "%08X %s, %s, %s: " OTTD_PRINTF64 " calls, " OTTD_PRINTF64 " nodes, %.3fms (%.1f%%), %.3fms/tick",
+				BSWAP32(e->grfid), GetNewGRFProfileGRFName(e->grfid), GetNewGRFProfileFeatureName(e->feature), callback,
+				(int64)e->calls, (int64)e->nodes, e->time / 1e6, total == 0 ? 0.0 : e->time * 100.0 / total,
+				_newgrf_profile_ticks == 0 ? 0.0 : e->time / 1e6 / _newgrf_profile_ticks);
+	}
+}
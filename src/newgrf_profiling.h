@@ -0,0 +1,49 @@
+/* $Id$ */
+
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file newgrf_profiling.h Profiling of the time NewGRFs take to resolve sprites and callbacks. */
+
+#ifndef NEWGRF_PROFILING_H
+#define NEWGRF_PROFILING_H
+
+#include "newgrf.h"
+#include "newgrf_callbacks.h"
+#include "core/smallvec_type.hpp"
+
+struct SpriteGroup;
+struct ResolverObject;
+
+/** Accumulated cost of the resolves of one NewGRF for one feature and callback. */
+struct NewGRFProfileEntry {
+	uint32 grfid;           ///< GRF ID of the NewGRF, or 0 for objects without a NewGRF.
+	GrfSpecFeature feature; ///< Feature of the resolved objects.
+	CallbackID callback;    ///< Callback that was resolved, #CBID_NO_CALLBACK for sprites.
+	uint64 calls;           ///< Number of resolves.
+	uint64 nodes;           ///< Number of sprite groups visited by the resolves.
+	uint64 cycles;          ///< Processor cycles spent in the resolves, excluding nested resolves of other objects.
+	uint64 time;            ///< #cycles converted to nanoseconds; only set by #GetNewGRFProfile.
+};
+
+typedef SmallVector<NewGRFProfileEntry, 32> NewGRFProfile;
+
+extern bool _newgrf_profiling;
+extern uint64 _sprite_group_resolve_count;
+extern uint64 _newgrf_profile_ticks;
+
+const SpriteGroup *ResolveProfiled(ResolverObject &object);
+
+void StartNewGRFProfiling();
+void StopNewGRFProfiling();
+void ResetNewGRFProfile();
+void GetNewGRFProfile(NewGRFProfile &profile);
+const char *GetNewGRFProfileFeatureName(GrfSpecFeature feature);
+const char *GetNewGRFProfileGRFName(uint32 grfid);
+bool ExportNewGRFProfile(const char *filename);
+
+#endif /* NEWGRF_PROFILING_H */
@@ -11,6 +11,8 @@
 
 #include "stdafx.h"
 #include <algorithm>
+#include <set>
+#include <map>
 #include "debug.h"
 #include "newgrf_spritegroup.h"
 #include "core/pool_func.hpp"
@@ -36,6 +38,7 @@ TemporaryStorageArray<int32, 0x110> _temp_store;
 /* static */ const SpriteGroup *SpriteGroup::Resolve(const SpriteGroup *group, ResolverObject &object, bool top_level)
 {
 	if (group == NULL) return NULL;
+	_sprite_group_resolve_count++;
 	if (top_level) {
 		_temp_store.ClearChanges();
 	}
@@ -52,6 +55,7 @@ DeterministicSpriteGroup::~DeterministicSpriteGroup()
 {
 	free(this->adjusts);
 	free(this->ranges);
+	free(this->range_table);
 }
 
 RandomizedSpriteGroup::~RandomizedSpriteGroup()
@@ -207,47 +211,125 @@ static bool RangeHighComparator(const DeterministicSpriteGroupRange& range, uint
 	return range.high < value;
 }
 
+/**
+ * Find the group the ranges select for a value.
+ * @param value Result of the adjusts.
+ * @return The group of the range containing \a value, or the default group.
+ */
+const SpriteGroup *DeterministicSpriteGroup::GetRangeGroup(uint32 value) const
+{
+	if (this->range_table != NULL) {
+		uint32 index = value - this->range_table_base;
+		return index < this->range_table_size ? this->range_table[index] : this->default_group;
+	}
+
+	if (this->num_ranges > 4) {
+		DeterministicSpriteGroupRange *lower = std::lower_bound(this->ranges + 0, this->ranges + this->num_ranges, value, RangeHighComparator);
+		if (lower != this->ranges + this->num_ranges && lower->low <= value) {
+			assert(lower->low <= value && value <= lower->high);
+			return lower->group;
+		}
+	} else {
+		for (uint i = 0; i < this->num_ranges; i++) {
+			if (this->ranges[i].low <= value && value <= this->ranges[i].high) {
+				return this->ranges[i].group;
+			}
+		}
+	}
+
+	return this->default_group;
+}
+
+/**
+ * Precompute what does not depend on the resolved object, once the group is completely read.
+ * Adjusts that only read constants are evaluated here, and the group they select is remembered.
+ * Ranges spanning few enough values are turned into a direct lookup table.
+ */
+void DeterministicSpriteGroup::Optimise()
+{
+	this->constant_result = true;
+	uint32 last_value = 0;
+	for (uint i = 0; i < this->num_adjusts; i++) {
+		const DeterministicSpriteGroupAdjust *adjust = &this->adjusts[i];
+
+		/* Only variable 1A is a constant; stores have side effects and a division by zero must still happen at runtime. */
+		if (adjust->variable != 0x1A || adjust->operation == DSGA_OP_STO || adjust->operation == DSGA_OP_STOP ||
+				(adjust->type != DSGA_TYPE_NONE && adjust->divmod_val == 0)) {
+			this->constant_result = false;
+			break;
+		}
+
+		switch (this->size) {
+			case DSG_SIZE_BYTE:  last_value = EvalAdjustT<uint8,  int8> (adjust, NULL, last_value, UINT_MAX); break;
+			case DSG_SIZE_WORD:  last_value = EvalAdjustT<uint16, int16>(adjust, NULL, last_value, UINT_MAX); break;
+			case DSG_SIZE_DWORD: last_value = EvalAdjustT<uint32, int32>(adjust, NULL, last_value, UINT_MAX); break;
+			default: NOT_REACHED();
+		}
+	}
+	if (this->constant_result) this->constant_value = last_value;
+
+	/* Below five ranges a linear search is just as fast, and large spans would waste memory. */
+	if (this->num_ranges > 4 && !this->constant_result) {
+		uint32 base = this->ranges[0].low;
+		uint32 span = this->ranges[this->num_ranges - 1].high - base;
+		if (span < 256 && span < this->num_ranges * 8) {
+			const SpriteGroup **table = MallocT<const SpriteGroup *>(span + 1);
+			for (uint32 i = 0; i <= span; i++) table[i] = this->GetRangeGroup(base + i);
+			this->range_table = table;
+			this->range_table_base = base;
+			this->range_table_size = span + 1;
+		}
+	}
+
+	if (this->constant_result) this->constant_group = this->GetRangeGroup(this->constant_value);
+}
+
 const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) const
 {
 	uint32 last_value = 0;
 	uint32 value = 0;
 	uint i;
 
-	ScopeResolver *scope = object.GetScope(this->var_scope);
-
-	for (i = 0; i < this->num_adjusts; i++) {
-		DeterministicSpriteGroupAdjust *adjust = &this->adjusts[i];
-
-		/* Try to get the variable. We shall assume it is available, unless told otherwise. */
-		bool available = true;
-		if (adjust->variable == 0x7E) {
-			const SpriteGroup *subgroup = SpriteGroup::Resolve(adjust->subroutine, object, false);
-			if (subgroup == NULL) {
-				value = CALLBACK_FAILED;
+	if (this->constant_result) {
+		/* The adjusts were already evaluated while loading. */
+		last_value = value = this->constant_value;
+	} else {
+		ScopeResolver *scope = object.GetScope(this->var_scope);
+
+		for (i = 0; i < this->num_adjusts; i++) {
+			DeterministicSpriteGroupAdjust *adjust = &this->adjusts[i];
+
+			/* Try to get the variable. We shall assume it is available, unless told otherwise. */
+			bool available = true;
+			if (adjust->variable == 0x7E) {
+				const SpriteGroup *subgroup = SpriteGroup::Resolve(adjust->subroutine, object, false);
+				if (subgroup == NULL) {
+					value = CALLBACK_FAILED;
+				} else {
+					value = subgroup->GetCallbackResult();
+				}
+
+				/* Note: 'last_value' and 'reseed' are shared between the main chain and the procedure */
+			} else if (adjust->variable == 0x7B) {
+				value = GetVariable(object, scope, adjust->parameter, last_value, &available);
 			} else {
-				value = subgroup->GetCallbackResult();
+				value = GetVariable(object, scope, adjust->variable, adjust->parameter, &available);
 			}
 
-			/* Note: 'last_value' and 'reseed' are shared between the main chain and the procedure */
-		} else if (adjust->variable == 0x7B) {
-			value = GetVariable(object, scope, adjust->parameter, last_value, &available);
-		} else {
-			value = GetVariable(object, scope, adjust->variable, adjust->parameter, &available);
-		}
-
-		if (!available) {
-			/* Unsupported variable: skip further processing and return either
-			 * the group from the first range or the default group. */
-			return SpriteGroup::Resolve(this->error_group, object, false);
-		}
+			if (!available) {
+				/* Unsupported variable: skip further processing and return either
+				 * the group from the first range or the default group. */
+				return SpriteGroup::Resolve(this->error_group, object, false);
+			}
 
-		switch (this->size) {
-			case DSG_SIZE_BYTE:  value = EvalAdjustT<uint8,  int8> (adjust, scope, last_value, value); break;
-			case DSG_SIZE_WORD:  value = EvalAdjustT<uint16, int16>(adjust, scope, last_value, value); break;
-			case DSG_SIZE_DWORD: value = EvalAdjustT<uint32, int32>(adjust, scope, last_value, value); break;
-			default: NOT_REACHED();
+			switch (this->size) {
+				case DSG_SIZE_BYTE:  value = EvalAdjustT<uint8,  int8> (adjust, scope, last_value, value); break;
+				case DSG_SIZE_WORD:  value = EvalAdjustT<uint16, int16>(adjust, scope, last_value, value); break;
+				case DSG_SIZE_DWORD: value = EvalAdjustT<uint32, int32>(adjust, scope, last_value, value); break;
+				default: NOT_REACHED();
+			}
+			last_value = value;
 		}
-		last_value = value;
 	}
 
 	object.last_value = last_value;
@@ -260,21 +342,8 @@ const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) con
 		return &nvarzero;
 	}
 
-	if (this->num_ranges > 4) {
-		DeterministicSpriteGroupRange *lower = std::lower_bound(this->ranges + 0, this->ranges + this->num_ranges, value, RangeHighComparator);
-		if (lower != this->ranges + this->num_ranges && lower->low <= value) {
-			assert(lower->low <= value && value <= lower->high);
-			return SpriteGroup::Resolve(lower->group, object, false);
-		}
-	} else {
-		for (i = 0; i < this->num_ranges; i++) {
-			if (this->ranges[i].low <= value && value <= this->ranges[i].high) {
-				return SpriteGroup::Resolve(this->ranges[i].group, object, false);
-			}
-		}
-	}
-
-	return SpriteGroup::Resolve(this->default_group, object, false);
+	if (this->constant_result) return SpriteGroup::Resolve(this->constant_group, object, false);
+	return SpriteGroup::Resolve(this->GetRangeGroup(value), object, false);
 }
 
 
@@ -329,3 +398,269 @@ const DrawTileSprites *TileLayoutSpriteGroup::ProcessRegisters(uint8 *stage) con
 
 	return &result;
 }
+
+/** Helper for #GetTileDrawInputs, walking the groups of a chain. */
+struct TileDrawAnalyser {
+	const TileDrawVariable *variables; ///< The feature specific variables that are cacheable.
+	uint num_variables;                ///< Number of elements in #variables.
+	std::set<const SpriteGroup *> seen; ///< Groups that have been analysed already.
+	TileDrawInputs inputs;             ///< The state of the tile read by the analysed groups.
+
+	/**
+	 * Add the state of the tile a variable reads.
+	 * @param variable The variable.
+	 */
+	void AddVariable(byte variable)
+	{
+		switch (variable) {
+			/* The callback and its parameters are fixed while drawing, the others are constant or only depend on the chain itself. */
+			case 0x0C: case 0x10: case 0x18: case 0x1A: case 0x1C: case 0x7E: case 0x7F:
+				return;
+
+			case 0x5F:
+				this->inputs |= TDI_RANDOM | TDI_TRIGGERS;
+				return;
+
+			default:
+				for (uint i = 0; i < this->num_variables; i++) {
+					if (this->variables[i].variable == variable) {
+						this->inputs |= this->variables[i].inputs;
+						return;
+					}
+				}
+				this->inputs |= TDI_UNCACHEABLE;
+				return;
+		}
+	}
+
+	/**
+	 * Add the state of the tile a group and the groups it refers to read.
+	 * @param group The group.
+	 */
+	void AddGroup(const SpriteGroup *group)
+	{
+		if (group == NULL || (this->inputs & TDI_UNCACHEABLE) != 0) return;
+		if (!this->seen.insert(group).second) return;
+
+		switch (group->type) {
+			case SGT_REAL: {
+				const RealSpriteGroup *real = (const RealSpriteGroup *)group;
+				for (uint i = 0; i < real->num_loaded; i++) this->AddGroup(real->loaded[i]);
+				for (uint i = 0; i < real->num_loading; i++) this->AddGroup(real->loading[i]);
+				break;
+			}
+
+			case SGT_DETERMINISTIC: {
+				const DeterministicSpriteGroup *det = (const DeterministicSpriteGroup *)group;
+				if (det->var_scope != VSG_SCOPE_SELF) {
+					this->inputs |= TDI_UNCACHEABLE;
+					return;
+				}
+				for (uint i = 0; i < det->num_adjusts; i++) {
+					const DeterministicSpriteGroupAdjust *adjust = &det->adjusts[i];
+					if (adjust->operation == DSGA_OP_STO || adjust->operation == DSGA_OP_STOP) {
+						this->inputs |= TDI_UNCACHEABLE;
+						return;
+					}
+					this->AddVariable(adjust->variable);
+					if (adjust->variable == 0x7E) this->AddGroup(adjust->subroutine);
+				}
+				for (uint i = 0; i < det->num_ranges; i++) this->AddGroup(det->ranges[i].group);
+				this->AddGroup(det->default_group);
+				break;
+			}
+
+			case SGT_RANDOMIZED: {
+				const RandomizedSpriteGroup *rnd = (const RandomizedSpriteGroup *)group;
+				if (rnd->var_scope != VSG_SCOPE_SELF) {
+					this->inputs |= TDI_UNCACHEABLE;
+					return;
+				}
+				this->inputs |= TDI_RANDOM;
+				for (uint i = 0; i < rnd->num_groups; i++) this->AddGroup(rnd->groups[i]);
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+};
+
+/**
+ * Determine the state of a tile an action 2 chain reads when it is resolved for drawing the tile.
+ * Chains reading anything else, like the parent scope or global variables, or storing
+ * into registers, are #TDI_UNCACHEABLE as their results may change at any time.
+ * @param root The root of the chain.
+ * @param variables The feature specific variables that only read the state of the tile.
+ * @param num_variables Number of elements in \a variables.
+ * @return The state of the tile the chain depends on.
+ */
+TileDrawInputs GetTileDrawInputs(const SpriteGroup *root, const TileDrawVariable *variables, uint num_variables)
+{
+	TileDrawAnalyser analyser;
+	analyser.variables = variables;
+	analyser.num_variables = num_variables;
+	analyser.inputs = TDI_NONE;
+	analyser.AddGroup(root);
+	return analyser.inputs;
+}
+
+/** Helper for #GetConstantCallbackResult, evaluating the groups of a chain for any resolved object. */
+struct ConstantCallbackAnalyser {
+	CallbackID callback;                           ///< The callback being resolved.
+	std::map<const SpriteGroup *, uint32> results; ///< Results of the groups that have been analysed already.
+
+	/**
+	 * Combine the results of two possible paths through a chain.
+	 * @param a Result of the one path.
+	 * @param b Result of the other path.
+	 * @return The common result, or #CALLBACK_VARIES.
+	 */
+	static uint32 Merge(uint32 a, uint32 b)
+	{
+		return a == b ? a : CALLBACK_VARIES;
+	}
+
+	/**
+	 * Get the callback result of a resolved group.
+	 * @param group The group, or \c NULL.
+	 * @return The callback result.
+	 */
+	static uint32 GetCallbackResult(const SpriteGroup *group)
+	{
+		return group == NULL ? CALLBACK_FAILED : group->GetCallbackResult();
+	}
+
+	/**
+	 * Determine the callback result of a group for any resolved object.
+	 * @param group The group.
+	 * @return The callback result, or #CALLBACK_VARIES.
+	 */
+	uint32 Analyse(const SpriteGroup *group)
+	{
+		if (group == NULL) return CALLBACK_FAILED;
+
+		std::map<const SpriteGroup *, uint32>::const_iterator it = this->results.find(group);
+		if (it != this->results.end()) return it->second;
+
+		uint32 result;
+		switch (group->type) {
+			case SGT_REAL: {
+				/* Whether and which loaded or loading group is taken depends on the feature and the object.
+				 * The taken group is not resolved any further. */
+				const RealSpriteGroup *real = (const RealSpriteGroup *)group;
+				result = CALLBACK_FAILED;
+				for (uint i = 0; i < real->num_loaded; i++) result = Merge(result, GetCallbackResult(real->loaded[i]));
+				for (uint i = 0; i < real->num_loading; i++) result = Merge(result, GetCallbackResult(real->loading[i]));
+				break;
+			}
+
+			case SGT_DETERMINISTIC:
+				result = this->AnalyseDeterministic((const DeterministicSpriteGroup *)group);
+				break;
+
+			case SGT_RANDOMIZED: {
+				/* The random bits differ for each object. */
+				const RandomizedSpriteGroup *rnd = (const RandomizedSpriteGroup *)group;
+				result = this->Analyse(rnd->groups[0]);
+				for (uint i = 1; i < rnd->num_groups && result != CALLBACK_VARIES; i++) result = Merge(result, this->Analyse(rnd->groups[i]));
+				break;
+			}
+
+			default:
+				result = group->GetCallbackResult();
+				break;
+		}
+
+		this->results[group] = result;
+		return result;
+	}
+
+	/**
+	 * Determine the callback result of a deterministic group for any resolved object.
+	 * Only the callback and constants are known; any other variable may have any value.
+	 * @param det The group.
+	 * @return The callback result, or #CALLBACK_VARIES.
+	 */
+	uint32 AnalyseDeterministic(const DeterministicSpriteGroup *det)
+	{
+		bool known = true;      // Whether the value of the adjusts so far is the same for all objects.
+		bool may_fail = false;  // Whether a variable might be unavailable, which selects the error group.
+		uint32 last_value = 0;
+
+		for (uint i = 0; i < det->num_adjusts; i++) {
+			const DeterministicSpriteGroupAdjust *adjust = &det->adjusts[i];
+
+			/* Stores are outputs of the callback, so it must really be resolved. */
+			if (adjust->operation == DSGA_OP_STO || adjust->operation == DSGA_OP_STOP) return CALLBACK_VARIES;
+
+			bool value_known = true;
+			uint32 value;
+			switch (adjust->variable) {
+				case 0x0C: value = this->callback; break;
+				case 0x1A: value = UINT_MAX; break;
+
+				case 0x7E:
+					value = this->Analyse(adjust->subroutine);
+					if (value == CALLBACK_VARIES) return CALLBACK_VARIES;
+					break;
+
+				default:
+					value_known = false;
+					may_fail = true;
+					break;
+			}
+
+			if (!value_known || (!known && adjust->operation != DSGA_OP_RST) || (adjust->type != DSGA_TYPE_NONE && adjust->divmod_val == 0)) {
+				known = false;
+				continue;
+			}
+
+			switch (det->size) {
+				case DSG_SIZE_BYTE:  last_value = EvalAdjustT<uint8,  int8> (adjust, NULL, last_value, value); break;
+				case DSG_SIZE_WORD:  last_value = EvalAdjustT<uint16, int16>(adjust, NULL, last_value, value); break;
+				case DSG_SIZE_DWORD: last_value = EvalAdjustT<uint32, int32>(adjust, NULL, last_value, value); break;
+				default: NOT_REACHED();
+			}
+			known = true;
+		}
+
+		uint32 result;
+		if (det->calculated_result) {
+			if (!known) return CALLBACK_VARIES;
+			result = (last_value == CALLBACK_FAILED) ? CALLBACK_FAILED : GB(last_value, 0, 15);
+		} else if (known) {
+			result = this->Analyse(det->GetRangeGroup(last_value));
+		} else {
+			result = this->Analyse(det->default_group);
+			for (uint i = 0; i < det->num_ranges && result != CALLBACK_VARIES; i++) result = Merge(result, this->Analyse(det->ranges[i].group));
+		}
+
+		if (may_fail && result != CALLBACK_VARIES) result = Merge(result, this->Analyse(det->error_group));
+		return result;
+	}
+};
+
+/**
+ * Determine whether a callback gives the same result for every object it can be resolved for.
+ * Only the callback ID and constants are assumed to be known, so callbacks that use their
+ * parameters or any property of the object are never constant. Neither are callbacks storing
+ * values into registers or persistent storage, as those are outputs of the callback as well.
+ * @param roots The root groups the object may be resolved with.
+ * @param num_roots Number of elements in \a roots.
+ * @param callback The callback; random triggers can not be analysed.
+ * @return The callback result for all objects, or #CALLBACK_VARIES.
+ */
+uint32 GetConstantCallbackResult(const SpriteGroup * const *roots, uint num_roots, CallbackID callback)
+{
+	assert(callback != CBID_RANDOM_TRIGGER && num_roots > 0);
+
+	ConstantCallbackAnalyser analyser;
+	analyser.callback = callback;
+	uint32 result = analyser.Analyse(roots[0]);
+	for (uint i = 1; i < num_roots && result != CALLBACK_VARIES; i++) {
+		result = ConstantCallbackAnalyser::Merge(result, analyser.Analyse(roots[i]));
+	}
+	return result;
+}
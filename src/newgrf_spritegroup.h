@@ -15,11 +15,13 @@
 #include "town_type.h"
 #include "engine_type.h"
 #include "house_type.h"
+#include "map_func.h"
 
 #include "newgrf_callbacks.h"
 #include "newgrf_generic.h"
 #include "newgrf_storage.h"
 #include "newgrf_commons.h"
+#include "newgrf_profiling.h"
 
 /**
  * Gets the value of a so-called newgrf "register".
@@ -184,6 +186,17 @@ struct DeterministicSpriteGroup : SpriteGroup {
 
 	const SpriteGroup *error_group; // was first range, before sorting ranges
 
+	bool constant_result;              ///< The adjusts only read constants, so they always yield #constant_value.
+	uint32 constant_value;             ///< Value of the adjusts when #constant_result is set.
+	const SpriteGroup *constant_group; ///< Group chosen by #constant_value when #constant_result is set and it is not a #calculated_result.
+
+	const SpriteGroup **range_table;   ///< Group for each value from #range_table_base onwards, or \c NULL when the ranges are searched.
+	uint32 range_table_base;           ///< First value in #range_table.
+	uint range_table_size;             ///< Number of values in #range_table.
+
+	void Optimise();
+	const SpriteGroup *GetRangeGroup(uint32 value) const;
+
 protected:
 	const SpriteGroup *Resolve(ResolverObject &object) const;
 };
@@ -344,6 +357,7 @@ struct ResolverObject {
 	 */
 	const SpriteGroup *Resolve()
 	{
+		if (_newgrf_profiling) return ResolveProfiled(*this);
 		return SpriteGroup::Resolve(this->root_spritegroup, *this);
 	}
 
@@ -361,6 +375,12 @@ struct ResolverObject {
 
 	virtual ScopeResolver *GetScope(VarSpriteGroupScope scope = VSG_SCOPE_SELF, byte relative = 0);
 
+	/**
+	 * Get the feature of the resolved object, for attributing its cost when profiling.
+	 * @return The feature, or #GSF_INVALID if unknown.
+	 */
+	virtual GrfSpecFeature GetFeature() const { return GSF_INVALID; }
+
 	/**
 	 * Returns the waiting triggers that did not trigger any rerandomisation.
 	 */
@@ -396,4 +416,170 @@ struct ResolverObject {
 	}
 };
 
+uint32 GetConstantCallbackResult(const SpriteGroup * const *roots, uint num_roots, CallbackID callback);
+
+/**
+ * Results of a callback for each entity of a feature, for the entities whose
+ * chain gives the same result regardless of the object it is resolved for.
+ * The chains are analysed on first use. The callback parameters are not taken into account.
+ * @tparam Tnum_ids Number of entity IDs of the feature.
+ */
+template <uint Tnum_ids>
+class ConstantCallbackResults {
+	uint32 results[Tnum_ids]; ///< Result for each entity, #CALLBACK_VARIES or #CALLBACK_UNKNOWN.
+
+public:
+	ConstantCallbackResults()
+	{
+		this->Clear();
+	}
+
+	/** Forget all analyses, e.g. because the NewGRFs are reloaded. */
+	void Clear()
+	{
+		for (uint i = 0; i < Tnum_ids; i++) this->results[i] = CALLBACK_UNKNOWN;
+	}
+
+	/**
+	 * Get the result of the callback for an entity, if it does not depend on the resolved object.
+	 * @param id The entity.
+	 * @param root The root of its action 2 chain.
+	 * @param callback The callback.
+	 * @return The callback result, or #CALLBACK_VARIES.
+	 */
+	inline uint32 Get(uint id, const SpriteGroup *root, CallbackID callback)
+	{
+		assert(id < Tnum_ids);
+		if (this->results[id] == CALLBACK_UNKNOWN) this->results[id] = GetConstantCallbackResult(&root, 1, callback);
+		if (this->results[id] != CALLBACK_VARIES) {
+			/* Resolving starts with cleared registers, and constant chains do not store any. */
+			extern TemporaryStorageArray<int32, 0x110> _temp_store;
+			_temp_store.ClearChanges();
+		}
+		return this->results[id];
+	}
+};
+
+/** State of a tile that an action 2 chain for drawing the tile may read. */
+enum TileDrawInputs {
+	TDI_NONE        = 0,      ///< The chain only reads constants and the position of the tile.
+	TDI_STAGE       = 1 << 0, ///< Construction stage of the tile.
+	TDI_AGE         = 1 << 1, ///< Age of the building on the tile.
+	TDI_ANIMATION   = 1 << 2, ///< Animation frame of the tile.
+	TDI_RANDOM      = 1 << 3, ///< Random bits of the tile.
+	TDI_TRIGGERS    = 1 << 4, ///< Waiting random triggers of the tile.
+	TDI_UNCACHEABLE = 1 << 6, ///< The chain reads other state, or has side effects, so its result may not be cached.
+	TDI_UNKNOWN     = 1 << 7, ///< The chain has not been analysed yet.
+};
+DECLARE_ENUM_AS_BIT_SET(TileDrawInputs)
+
+/** A feature specific variable an action 2 chain for drawing a tile may read without making it uncacheable. */
+struct TileDrawVariable {
+	byte variable;         ///< The variable.
+	TileDrawInputs inputs; ///< The state of the tile the variable depends on.
+};
+
+TileDrawInputs GetTileDrawInputs(const SpriteGroup *root, const TileDrawVariable *variables, uint num_variables);
+
+/**
+ * Cache of the groups action 2 chains resolve to when drawing tiles.
+ * Every entity gets its chain analysed once to find the state of the tile it depends on;
+ * as long as that state does not change, redrawing the tile does not need to resolve the chain.
+ * The cache is direct mapped on the tile, so it covers a block of #SIZE_BITS by #SIZE_BITS tiles.
+ * @tparam Tnum_ids Number of entity IDs of the feature.
+ */
+template <uint Tnum_ids>
+class TileDrawCache {
+	static const uint SIZE_BITS = 6; ///< Log2 of the width and height of the covered block of tiles.
+
+	/** Resolved group of a single tile. */
+	struct Entry {
+		TileIndex tile;            ///< The tile, or #INVALID_TILE when the entry is unused.
+		uint16 id;                 ///< The entity on the tile.
+		uint64 key;                ///< The state of the tile the chain depends on.
+		const SpriteGroup *result; ///< The resolved group.
+	};
+
+	Entry entries[1 << (2 * SIZE_BITS)]; ///< Cached groups, indexed by the position of the tile.
+	TileDrawInputs inputs[Tnum_ids];     ///< State of the tile the chain of each entity depends on.
+
+	/**
+	 * Get the entry a tile is cached in.
+	 * @param tile The tile.
+	 * @return The entry.
+	 */
+	inline Entry *GetEntry(TileIndex tile)
+	{
+		return &this->entries[(TileX(tile) & ((1 << SIZE_BITS) - 1)) | (TileY(tile) & ((1 << SIZE_BITS) - 1)) << SIZE_BITS];
+	}
+
+public:
+	TileDrawCache()
+	{
+		this->Clear();
+	}
+
+	/** Forget all resolved groups and analyses, e.g. because the NewGRFs are reloaded. */
+	void Clear()
+	{
+		for (uint i = 0; i < lengthof(this->entries); i++) this->entries[i].tile = INVALID_TILE;
+		for (uint i = 0; i < Tnum_ids; i++) this->inputs[i] = TDI_UNKNOWN;
+	}
+
+	/**
+	 * Get the state of the tile the drawing chain of an entity depends on.
+	 * @param id The entity.
+	 * @param root The root of its action 2 chain.
+	 * @param variables The feature specific variables that are cacheable.
+	 * @param num_variables Number of elements in  variables.
+	 * @return The state of the tile, or #TDI_UNCACHEABLE.
+	 */
+	inline TileDrawInputs GetInputs(uint id, const SpriteGroup *root, const TileDrawVariable *variables, uint num_variables)
+	{
+		assert(id < Tnum_ids);
+		if (this->inputs[id] == TDI_UNKNOWN) this->inputs[id] = GetTileDrawInputs(root, variables, num_variables);
+		return this->inputs[id];
+	}
+
+	/**
+	 * Look up the group a tile resolved to before.
+	 * @param tile The tile.
+	 * @param id The entity on the tile.
+	 * @param key The state of the tile, as given by #GetInputs.
+	 * @param [out] result The resolved group.
+	 * @return Whether the group was cached.
+	 */
+	inline bool Lookup(TileIndex tile, uint id, uint64 key, const SpriteGroup **result)
+	{
+		const Entry *entry = this->GetEntry(tile);
+		if (entry->tile != tile || entry->id != id || entry->key != key) return false;
+
+		/* Resolving starts with cleared registers, and cached chains do not store any. */
+		extern TemporaryStorageArray<int32, 0x110> _temp_store;
+		_temp_store.ClearChanges();
+
+		/* Count the lookup as a visited group, so it is noticed like a real resolve. */
+		_sprite_group_resolve_count++;
+
+		*result = entry->result;
+		return true;
+	}
+
+	/**
+	 * Remember the group a tile resolved to.
+	 * @param tile The tile.
+	 * @param id The entity on the tile.
+	 * @param key The state of the tile, as given by #GetInputs.
+	 * @param result The resolved group.
+	 */
+	inline void Store(TileIndex tile, uint id, uint64 key, const SpriteGroup *result)
+	{
+		Entry *entry = this->GetEntry(tile);
+		entry->tile = tile;
+		entry->id = id;
+		entry->key = key;
+		entry->result = result;
+	}
+};
+
 #endif /* NEWGRF_SPRITEGROUP_H */
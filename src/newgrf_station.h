@@ -77,6 +77,8 @@ struct StationResolverObject : public ResolverObject {
 	}
 
 	/* virtual */ const SpriteGroup *ResolveReal(const RealSpriteGroup *group) const;
+
+	/* virtual */ GrfSpecFeature GetFeature() const { return GSF_STATIONS; }
 };
 
 enum StationClassID {
@@ -13,6 +13,7 @@
 #define NEWGRF_STORAGE_H
 
 #include "core/pool_type.hpp"
+#include "core/smallvec_type.hpp"
 #include "tile_type.h"
 
 /**
@@ -61,26 +62,28 @@ private:
 /**
  * Class for persistent storage of data.
  * On #ClearChanges that data is either reverted or saved.
+ * Only the slots that are changed while changes are temporary are recorded,
+ * so reverting costs nothing for arrays that were only read.
  * @tparam TYPE the type of variable to store.
  * @tparam SIZE the size of the array.
  */
 template <typename TYPE, uint SIZE>
 struct PersistentStorageArray : BasePersistentStorageArray {
-	TYPE storage[SIZE]; ///< Memory to for the storage array
-	TYPE *prev_storage; ///< Memory to store "old" states so we can revert them on the performance of test cases for commands etc.
+	/** Old value of a slot, to revert a temporary change. */
+	struct StorageChange {
+		uint16 pos; ///< Position of the changed slot.
+		TYPE value; ///< Value of the slot before the change.
+	};
+
+	TYPE storage[SIZE];                    ///< Memory to for the storage array
+	SmallVector<StorageChange, 4> changes; ///< Temporary changes in the order they were made, so we can revert them on the performance of test cases for commands etc.
 
 	/** Simply construct the array */
-	PersistentStorageArray() : prev_storage(NULL)
+	PersistentStorageArray()
 	{
 		memset(this->storage, 0, sizeof(this->storage));
 	}
 
-	/** And free all data related to it */
-	~PersistentStorageArray()
-	{
-		free(this->prev_storage);
-	}
-
 	/** Resets all values to zero. */
 	void ResetToZero()
 	{
@@ -89,8 +92,8 @@ struct PersistentStorageArray : BasePersistentStorageArray {
 
 	/**
 	 * Stores some value at a given position.
-	 * If there is no backup of the data that backup is made and then
-	 * we write the data.
+	 * If changes are temporary, the old value is recorded first so the
+	 * change can be reverted.
 	 * @param pos   the position to write at
 	 * @param value the value to write
 	 */
@@ -103,16 +106,16 @@ struct PersistentStorageArray : BasePersistentStorageArray {
 		 * Saves a few cycles and such and it's pretty easy to check. */
 		if (this->storage[pos] == value) return;
 
-		/* We do not have made a backup; lets do so */
 		if (AreChangesPersistent()) {
-			assert(this->prev_storage == NULL);
-		} else if (this->prev_storage == NULL) {
-			this->prev_storage = MallocT<TYPE>(SIZE);
-			memcpy(this->prev_storage, this->storage, sizeof(this->storage));
-
-			/* We only need to register ourselves when we made the backup
+			assert(this->changes.Length() == 0);
+		} else {
+			/* We only need to register ourselves on the first change
 			 * as that is the only time something will have changed */
-			AddChangedPersistentStorage(this);
+			if (this->changes.Length() == 0) AddChangedPersistentStorage(this);
+
+			StorageChange *change = this->changes.Append();
+			change->pos = pos;
+			change->value = this->storage[pos];
 		}
 
 		this->storage[pos] = value;
@@ -133,11 +136,12 @@ struct PersistentStorageArray : BasePersistentStorageArray {
 
 	void ClearChanges()
 	{
-		if (this->prev_storage != NULL) {
-			memcpy(this->storage, this->prev_storage, sizeof(this->storage));
-			free(this->prev_storage);
-			this->prev_storage = NULL;
+		/* Undo the changes last to first, so a slot changed several times gets its oldest value. */
+		for (const StorageChange *change = this->changes.End(); change != this->changes.Begin(); ) {
+			change--;
+			this->storage[change->pos] = change->value;
 		}
+		this->changes.Clear();
 	}
 };
 
@@ -62,8 +62,10 @@
 #include "town.h"
 #include "subsidy_func.h"
 #include "gfx_layout.h"
+#include "viewport_func.h"
 #include "viewport_sprite_sorter.h"
 #include "framerate_type.h"
+#include "newgrf_profiling.h"
 
 #include "linkgraph/linkgraphschedule.h"
 
@@ -290,6 +292,7 @@ static void ShutdownGame()
 	DriverFactoryBase::ShutdownDrivers();
 
 	UnInitWindowSystem();
+	StopViewportSortThread();
 
 	/* stop the scripts */
 	AI::Uninitialize(false);
@@ -1357,6 +1360,8 @@ void StateGameLoop()
 	PerformanceAccumulator::Reset(PFE_GL_LANDSCAPE);
 	if (HasModalProgress()) return;
 
+	if (_newgrf_profiling) _newgrf_profile_ticks++;
+
 	Layouter::ReduceLineCache();
 
 	if (_game_mode == GM_EDITOR) {
@@ -287,6 +287,8 @@ static void InitializeWindowsAndCaches()
 	GroupStatistics::UpdateAfterLoad();
 
 	Station::RecomputeIndustriesNearForAll();
+	Industry::RecomputeStationsNearForAll();
+	SyncIndustryCounters();
 	RebuildSubsidisedSourceAndDestinationCache();
 
 	/* Towns have a noise controlled number of airports system
@@ -588,14 +590,14 @@ bool AfterLoadGame()
 
 		/* In old savegame versions, the heightlevel was coded in bits 0..3 of the type field */
 		for (TileIndex t = 0; t < map_size; t++) {
-			_m[t].height = GB(_m[t].type, 0, 4);
-			SB(_m[t].type, 0, 2, GB(_me[t].m6, 0, 2));
+			_mb[t].height = GB(_mb[t].type, 0, 4);
+			SB(_mb[t].type, 0, 2, GB(_me[t].m6, 0, 2));
 			SB(_me[t].m6, 0, 2, 0);
 			if (MayHaveBridgeAbove(t)) {
-				SB(_m[t].type, 2, 2, GB(_me[t].m6, 6, 2));
+				SB(_mb[t].type, 2, 2, GB(_me[t].m6, 6, 2));
 				SB(_me[t].m6, 6, 2, 0);
 			} else {
-				SB(_m[t].type, 2, 2, 0);
+				SB(_mb[t].type, 2, 2, 0);
 			}
 		}
 	}
@@ -2190,6 +2192,7 @@ bool AfterLoadGame()
 		 * in case of old savegames duplicate. */
 
 		extern SmallVector<TileIndex, 256> _animated_tiles;
+		extern void RebuildAnimatedTileIndex();
 
 		for (TileIndex *tile = _animated_tiles.Begin(); tile < _animated_tiles.End(); /* Nothing */) {
 			/* Remove if tile is not animated */
@@ -2201,11 +2204,12 @@ bool AfterLoadGame()
 			}
 
 			if (remove) {
-				DeleteAnimatedTile(*tile);
+				_animated_tiles.ErasePreservingOrder(tile);
 			} else {
 				tile++;
 			}
 		}
+		RebuildAnimatedTileIndex();
 	}
 
 	if (IsSavegameVersionBefore(124) && !IsSavegameVersionBefore(1)) {
@@ -69,6 +69,9 @@ static void Save_INDY()
 {
 	Industry *ind;
 
+	/* Store the actual counters, not the ones relative to the tick schedule. */
+	SyncIndustryCounters();
+
 	/* Write the industries */
 	FOR_ALL_INDUSTRIES(ind) {
 		SlSetArrayIndex(ind->index);
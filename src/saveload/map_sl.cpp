@@ -56,7 +56,7 @@ static void Load_MAPT()
 
 	for (TileIndex i = 0; i != size;) {
 		SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].type = buf[j];
+		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _mb[i++].type = buf[j];
 	}
 }
 
@@ -67,7 +67,7 @@ static void Save_MAPT()
 
 	SlSetLength(size);
 	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _m[i++].type;
+		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _mb[i++].type;
 		SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT8);
 	}
 }
@@ -79,7 +79,7 @@ static void Load_MAPH()
 
 	for (TileIndex i = 0; i != size;) {
 		SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].height = buf[j];
+		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _mb[i++].height = buf[j];
 	}
 }
 
@@ -90,7 +90,7 @@ static void Save_MAPH()
 
 	SlSetLength(size);
 	for (TileIndex i = 0; i != size;) {
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _m[i++].height;
+		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _mb[i++].height;
 		SlArray(buf, MAP_SL_BUF_SIZE, SLE_UINT8);
 	}
 }
@@ -49,6 +49,7 @@ void FixOldMapArray()
 	/* TTO/TTD/TTDP savegames could have buoys at tile 0
 	 * (without assigned station struct) */
 	MemSetT(&_m[0], 0);
+	MemSetT(&_mb[0], 0);
 	SetTileType(0, MP_WATER);
 	SetTileOwner(0, OWNER_WATER);
 }
@@ -492,6 +493,7 @@ static inline uint RemapOrderIndex(uint x)
 }
 
 extern SmallVector<TileIndex, 256> _animated_tiles;
+extern void RebuildAnimatedTileIndex();
 extern char *_old_name_array;
 
 static uint32 _old_town_index;
@@ -653,6 +655,7 @@ static bool LoadOldAnimTileList(LoadgameState *ls, int num)
 		if (anim_list[i] == 0) break;
 		*_animated_tiles.Append() = anim_list[i];
 	}
+	RebuildAnimatedTileIndex();
 
 	return true;
 }
@@ -1473,6 +1476,7 @@ static bool LoadOldGameDifficulty(LoadgameState *ls, int num)
 static bool LoadOldMapPart1(LoadgameState *ls, int num)
 {
 	if (_savegame_type == SGT_TTO) {
+		MemSetT(_mb, 0, OLD_MAP_SIZE);
 		MemSetT(_m, 0, OLD_MAP_SIZE);
 		MemSetT(_me, 0, OLD_MAP_SIZE);
 	}
@@ -1506,7 +1510,7 @@ static bool LoadOldMapPart2(LoadgameState *ls, int num)
 	uint i;
 
 	for (i = 0; i < OLD_MAP_SIZE; i++) {
-		_m[i].type = ReadByte(ls);
+		_mb[i].type = ReadByte(ls);
 	}
 	for (i = 0; i < OLD_MAP_SIZE; i++) {
 		_m[i].m5 = ReadByte(ls);
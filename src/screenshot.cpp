@@ -25,6 +25,8 @@
 #include "window_func.h"
 #include "tile_map.h"
 #include "landscape.h"
+#include "smallmap_gui.h"
+#include "thread/thread.h"
 
 #include "table/strings.h"
 
@@ -242,6 +244,186 @@ static void PNGAPI png_my_warning(png_structp png_ptr, png_const_charp message)
 	DEBUG(misc, 1, "[libpng] warning: %s - %s", message, (const char *)png_get_error_ptr(png_ptr));
 }
 
+/**
+ * State shared between #MakePNGImage and the thread compressing the blocks of
+ * rows it generates, so generating the next block overlaps with compressing
+ * and writing the previous one. Each direction of the handshake has its own
+ * mutex, so every signal has only one thread waiting for it.
+ */
+struct PNGWriterThread {
+	png_structp png_ptr;      ///< The image being written; only touched by the thread while it runs.
+	png_infop info_ptr;       ///< Info of the image being written.
+	ThreadMutex *work_mutex;  ///< Mutex guarding #buff, #n and #done; signalled by #MakePNGImage.
+	ThreadMutex *free_mutex;  ///< Mutex guarding #busy and #failed; signalled by the thread.
+	const void *buff;         ///< Block of rows to write, or \c NULL when the thread is waiting for one.
+	uint pitch;               ///< Number of bytes per row in #buff.
+	uint n;                   ///< Number of rows in #buff.
+	bool done;                ///< Whether all rows have been handed over.
+	bool busy;                ///< Whether the thread is still writing the last handed over block.
+	bool failed;              ///< Whether libpng reported an error.
+};
+
+/**
+ * Main loop of the PNG writer thread.
+ * @param param The #PNGWriterThread to serve.
+ */
+static void PNGWriterThreadProc(void *param)
+{
+	PNGWriterThread *wt = (PNGWriterThread *)param;
+
+	/* libpng errors jump back to the last setjmp; that has to be on this thread's stack.
+	 * MakePNGImage makes no libpng calls while this thread runs and restores its own afterwards. */
+	if (setjmp(png_jmpbuf(wt->png_ptr))) {
+		wt->free_mutex->BeginCritical();
+		wt->failed = true;
+		wt->busy = false;
+		wt->free_mutex->SendSignal();
+		wt->free_mutex->EndCritical();
+		return;
+	}
+
+	for (;;) {
+		wt->work_mutex->BeginCritical();
+		while (wt->buff == NULL && !wt->done) wt->work_mutex->WaitForSignal();
+		const void *buff = wt->buff;
+		uint n = wt->n;
+		wt->buff = NULL;
+		wt->work_mutex->EndCritical();
+		if (buff == NULL) break;
+
+		for (uint i = 0; i != n; i++) {
+			png_write_row(wt->png_ptr, (png_const_bytep)buff + i * wt->pitch);
+		}
+
+		wt->free_mutex->BeginCritical();
+		wt->busy = false;
+		wt->free_mutex->SendSignal();
+		wt->free_mutex->EndCritical();
+	}
+
+	png_write_end(wt->png_ptr, wt->info_ptr);
+}
+
+/**
+ * Start a thread compressing and writing the rows of a PNG image.
+ * @param wt     State to initialise and share with the thread.
+ * @param pitch  Number of bytes per row.
+ * @return The started thread, or \c NULL when the rows have to be written by the caller.
+ */
+static ThreadObject *StartPNGWriterThread(PNGWriterThread *wt, uint pitch)
+{
+	if (GetCPUCoreCount() <= 1) return NULL;
+
+	wt->work_mutex = ThreadMutex::New();
+	wt->free_mutex = ThreadMutex::New();
+	wt->buff = NULL;
+	wt->pitch = pitch;
+	wt->n = 0;
+	wt->done = false;
+	wt->busy = false;
+	wt->failed = false;
+
+	ThreadObject *thread;
+	if (ThreadObject::New(&PNGWriterThreadProc, wt, &thread, "ottd:png")) return thread;
+
+	delete wt->work_mutex;
+	delete wt->free_mutex;
+	return NULL;
+}
+
+/**
+ * Generate the rows of a PNG image and write them, on a separate thread when possible.
+ * This is kept out of #MakePNGImage so none of the state changed here is
+ * read there after libpng jumps back to its setjmp.
+ * @param png_ptr  The image being written.
+ * @param info_ptr Info of the image being written.
+ * @param callb    Callback function for generating lines of pixels.
+ * @param userdata User data, passed on to \a callb.
+ * @param w        Width of the image in pixels.
+ * @param h        Height of the image in pixels.
+ * @param bpp      Bytes per pixel.
+ * @return False when the writer thread reported an error.
+ */
+static bool WritePNGRows(png_structp png_ptr, png_infop info_ptr, ScreenshotCallback *callb, void *userdata, uint w, uint h, uint bpp)
+{
+	/* use by default 64k temp memory */
+	uint maxlines = Clamp(65536 / w, 16, 128);
+
+	/* When the image does not fit in one block, compress and write the rows on
+	 * a separate thread while the next block is generated. Generating itself
+	 * stays on this thread as drawing the viewport is not thread safe. */
+	PNGWriterThread wt;
+	wt.png_ptr = png_ptr;
+	wt.info_ptr = info_ptr;
+	ThreadObject *thread = h > maxlines ? StartPNGWriterThread(&wt, w * bpp) : NULL;
+
+	/* The thread sets its own setjmp, which is gone with its stack once it is done;
+	 * libpng errors have to jump back to the setjmp of MakePNGImage again afterwards. */
+	jmp_buf jmpbuf;
+	if (thread != NULL) memcpy(jmpbuf, png_jmpbuf(png_ptr), sizeof(jmpbuf));
+
+	/* now generate the bitmap bits */
+	void *buff[2];
+	buff[0] = CallocT<uint8>(w * maxlines * bpp); // by default generate 128 lines at a time.
+	buff[1] = thread != NULL ? CallocT<uint8>(w * maxlines * bpp) : NULL;
+	bool success = true;
+
+	uint y = 0;
+	do {
+		/* determine # lines to write */
+		uint n = min(h - y, maxlines);
+
+		/* render the pixels into the buffer */
+		callb(userdata, buff[0], y, w, n);
+		y += n;
+
+		if (thread == NULL) {
+			/* write them to png */
+			for (uint i = 0; i != n; i++) {
+				png_write_row(png_ptr, (png_bytep)buff[0] + i * w * bpp);
+			}
+			continue;
+		}
+
+		/* hand them to the writer thread once it is done with the previous block */
+		wt.free_mutex->BeginCritical();
+		while (wt.busy) wt.free_mutex->WaitForSignal();
+		success = !wt.failed;
+		wt.busy = success;
+		wt.free_mutex->EndCritical();
+		if (!success) break;
+
+		wt.work_mutex->BeginCritical();
+		wt.buff = buff[0];
+		wt.n = n;
+		wt.work_mutex->SendSignal();
+		wt.work_mutex->EndCritical();
+
+		Swap(buff[0], buff[1]);
+	} while (y != h);
+
+	if (thread != NULL) {
+		wt.work_mutex->BeginCritical();
+		wt.done = true;
+		wt.work_mutex->SendSignal();
+		wt.work_mutex->EndCritical();
+
+		thread->Join();
+		delete thread;
+		delete wt.work_mutex;
+		delete wt.free_mutex;
+		success = !wt.failed;
+
+		memcpy(png_jmpbuf(png_ptr), jmpbuf, sizeof(jmpbuf));
+	} else {
+		png_write_end(png_ptr, info_ptr);
+	}
+
+	free(buff[0]);
+	free(buff[1]);
+	return success;
+}
+
 /**
  * Generic .PNG file image writer.
  * @param name        Filename, including extension.
@@ -258,8 +440,7 @@ static bool MakePNGImage(const char *name, ScreenshotCallback *callb, void *user
 {
 	png_color rq[256];
 	FILE *f;
-	uint i, y, n;
-	uint maxlines;
+	uint i;
 	uint bpp = pixelformat / 8;
 	png_structp png_ptr;
 	png_infop info_ptr;
@@ -365,33 +546,11 @@ static bool MakePNGImage(const char *name, ScreenshotCallback *callb, void *user
 #endif /* TTD_ENDIAN == TTD_LITTLE_ENDIAN */
 	}
 
-	/* use by default 64k temp memory */
-	maxlines = Clamp(65536 / w, 16, 128);
-
-	/* now generate the bitmap bits */
-	void *buff = CallocT<uint8>(w * maxlines * bpp); // by default generate 128 lines at a time.
-
-	y = 0;
-	do {
-		/* determine # lines to write */
-		n = min(h - y, maxlines);
-
-		/* render the pixels into the buffer */
-		callb(userdata, buff, y, w, n);
-		y += n;
-
-		/* write them to png */
-		for (i = 0; i != n; i++) {
-			png_write_row(png_ptr, (png_bytep)buff + i * w * bpp);
-		}
-	} while (y != h);
-
-	png_write_end(png_ptr, info_ptr);
+	bool success = WritePNGRows(png_ptr, info_ptr, callb, userdata, w, h, bpp);
 	png_destroy_write_struct(&png_ptr, &info_ptr);
 
-	free(buff);
 	fclose(f);
-	return true;
+	return success;
 }
 #endif /* WITH_PNG */
 
@@ -803,6 +962,43 @@ bool MakeHeightmapScreenshot(const char *filename)
 	return sf->proc(filename, HeightmapCallback, NULL, MapSizeX(), MapSizeY(), 8, palette);
 }
 
+/**
+ * Callback for generating a top down map of the world, with the tiles in the
+ * colours of the small map in mode "Owner". Supports 8bpp only.
+ * @param userdata Pointer to user data.
+ * @param buf      Destination buffer.
+ * @param y        Line number of the first line to write.
+ * @param pitch    Number of pixels to write (1 byte for 8bpp, 4 bytes for 32bpp). @see Colour
+ * @param n        Number of lines to write.
+ * @see ScreenshotCallback
+ */
+static void MinimapCallback(void *userdata, void *buffer, uint y, uint pitch, uint n)
+{
+	byte *buf = (byte *)buffer;
+	while (n > 0) {
+		TileIndex ti = TileXY(MapMaxX(), y);
+		for (uint x = MapMaxX(); true; x--) {
+			*buf = GetSmallMapOwnerColour(ti);
+			buf++;
+			if (x == 0) break;
+			ti = TILE_ADDXY(ti, -1, 0);
+		}
+		y++;
+		n--;
+	}
+}
+
+/**
+ * Make a top down map of the current map, one pixel per tile. As it does not
+ * draw any sprites, this also works on dedicated servers.
+ * @param filename Filename to use for saving.
+ */
+bool MakeMinimapScreenshot(const char *filename)
+{
+	const ScreenshotFormat *sf = _screenshot_formats + _cur_screenshot_format;
+	return sf->proc(filename, MinimapCallback, NULL, MapSizeX(), MapSizeY(), 8, _cur_palette.palette);
+}
+
 /**
  * Make an actual screenshot.
  * @param t    the type of screenshot to make.
@@ -845,6 +1041,12 @@ bool MakeScreenshot(ScreenshotType t, const char *name)
 			break;
 		}
 
+		case SC_MINIMAP: {
+			const ScreenshotFormat *sf = _screenshot_formats + _cur_screenshot_format;
+			ret = MakeMinimapScreenshot(MakeScreenshotName(SCREENSHOT_NAME, sf->extension));
+			break;
+		}
+
 		default:
 			NOT_REACHED();
 	}
@@ -777,6 +777,12 @@ public:
 		 */
 		WC_FRAMETIME_GRAPH                           = ::WC_FRAMETIME_GRAPH,
 
+		/**
+		 * NewGRF profile (debug); %Window numbers:
+		 *   - 0 = #NewGRFProfileWidgets
+		 */
+		WC_NEWGRF_PROFILE                            = ::WC_NEWGRF_PROFILE,
+
 		WC_INVALID                                   = ::WC_INVALID,                                   ///< Invalid window.
 	};
 
@@ -1296,6 +1302,7 @@ public:
 		WID_FRW_RATE_DRAWING                         = ::WID_FRW_RATE_DRAWING,
 		WID_FRW_RATE_FACTOR                          = ::WID_FRW_RATE_FACTOR,
 		WID_FRW_INFO_DATA_POINTS                     = ::WID_FRW_INFO_DATA_POINTS,
+		WID_FRW_INFO_SPRITE_CACHE                    = ::WID_FRW_INFO_SPRITE_CACHE,
 		WID_FRW_TIMES_NAMES                          = ::WID_FRW_TIMES_NAMES,
 		WID_FRW_TIMES_CURRENT                        = ::WID_FRW_TIMES_CURRENT,
 		WID_FRW_TIMES_AVERAGE                        = ::WID_FRW_TIMES_AVERAGE,
@@ -1843,6 +1850,15 @@ public:
 		WID_SA_RESET_REL                             = ::WID_SA_RESET_REL,                             ///< Reset relative sprite offset
 	};
 
+	/** Widgets of the #NewGRFProfileWindow class. */
+	enum NewGRFProfileWidgets {
+		WID_NGRFP_START                              = ::WID_NGRFP_START,                              ///< Start or stop profiling.
+		WID_NGRFP_RESET                              = ::WID_NGRFP_RESET,                              ///< Remove the collected data.
+		WID_NGRFP_SUMMARY                            = ::WID_NGRFP_SUMMARY,                            ///< Profiled ticks and total time.
+		WID_NGRFP_LIST                               = ::WID_NGRFP_LIST,                               ///< Cost per NewGRF, feature and callback.
+		WID_NGRFP_SCROLLBAR                          = ::WID_NGRFP_SCROLLBAR,                          ///< Scrollbar.
+	};
+
 	/* automatically generated from ../../widgets/newgrf_widget.h */
 	/** Widgets of the #NewGRFParametersWindow class. */
 	enum NewGRFParametersWidgets {
@@ -67,6 +67,7 @@
 
 #include "void_map.h"
 #include "station_base.h"
+#include "industry.h"
 
 #include "table/strings.h"
 #include "table/settings.h"
@@ -1302,6 +1303,7 @@ static bool ChangeMaxHeightLevel(int32 p1)
 static bool StationCatchmentChanged(int32 p1)
 {
 	Station::RecomputeIndustriesNearForAll();
+	Industry::RecomputeStationsNearForAll();
 	return true;
 }
 
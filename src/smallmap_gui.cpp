@@ -168,6 +168,12 @@ static IndustryType _smallmap_industry_highlight = INVALID_INDUSTRYTYPE;
 static bool _smallmap_industry_highlight_state;
 /** For connecting company ID to position in owner list (small map legend) */
 static uint _company_to_list_pos[MAX_COMPANIES];
+/** Changed whenever the colours of the land or owner legend are rebuilt. */
+static uint _smallmap_legend_version = 0;
+/** Bitmap of the tiles marked dirty since the smallmap was last refreshed, or \c NULL when there is no smallmap. */
+static uint32 *_smallmap_dirty_tiles = NULL;
+/** Number of tiles in #_smallmap_dirty_tiles. */
+static uint _smallmap_dirty_tiles_size = 0;
 
 /**
  * Fills an array for the industries legends.
@@ -281,6 +287,8 @@ static SmallMapColourScheme _heightmap_schemes[] = {
  */
 void BuildLandLegend()
 {
+	_smallmap_legend_version++;
+
 	/* The smallmap window has never been initialized, so no need to change the legend. */
 	if (_heightmap_schemes[0].height_colours == NULL) return;
 
@@ -332,6 +340,8 @@ void BuildLandLegend()
  */
 void BuildOwnerLegend()
 {
+	_smallmap_legend_version++;
+
 	_legend_land_owners[1].colour = _heightmap_schemes[_settings_client.gui.smallmap_land_colour].default_colour;
 
 	int i = NUM_NO_COMPANY_ENTRIES;
@@ -566,6 +576,73 @@ static inline uint32 GetSmallMapOwnerPixels(TileIndex tile, TileType t)
 	return MKCOLOUR_XXXX(_legend_land_owners[_company_to_list_pos[o]].colour);
 }
 
+/**
+ * Get the palette colour of a tile as the small map shows it in mode "Owner".
+ * Unlike the small map window this does not need any window state, so it can
+ * be used by dedicated servers too.
+ * @param tile The tile of which we would like to get the colour.
+ * @return Palette index of the colour of the tile.
+ */
+uint8 GetSmallMapOwnerColour(TileIndex tile)
+{
+	TileType t = GetTileType(tile);
+	if (t == MP_TUNNELBRIDGE && GetTunnelBridgeTransportType(tile) == TRANSPORT_WATER) t = MP_WATER;
+
+	return GB(GetSmallMapOwnerPixels(tile, t), 0, 8);
+}
+
+/**
+ * Mark a tile as changed, so the smallmap looks up its colour again on the next refresh.
+ * @param tile The changed tile.
+ */
+void MarkSmallMapTileDirty(TileIndex tile)
+{
+	if (tile < _smallmap_dirty_tiles_size) SetBit(_smallmap_dirty_tiles[tile / 32], tile % 32);
+}
+
+/**
+ * Throw away all cached colours and set up the cache for different groups of tiles.
+ * @param zoom     Zoom level of the groups.
+ * @param offset_x X coordinate of the first tile of every group, modulo \a zoom.
+ * @param offset_y Y coordinate of the first tile of every group, modulo \a zoom.
+ */
+void SmallMapColourCache::Reset(int zoom, uint offset_x, uint offset_y)
+{
+	uint size_x = CeilDiv(MapSizeX(), zoom);
+	uint size_y = CeilDiv(MapSizeY(), zoom);
+	if (size_x * size_y > this->size_x * this->size_y) {
+		free(this->colours);
+		free(this->valid);
+		this->colours = MallocT<uint32>(size_x * size_y);
+		this->valid = MallocT<uint32>(CeilDiv(size_x * size_y, 32));
+	}
+	MemSetT(this->valid, 0, CeilDiv(size_x * size_y, 32));
+
+	this->size_x = size_x;
+	this->size_y = size_y;
+	this->zoom = zoom;
+	this->offset_x = offset_x;
+	this->offset_y = offset_y;
+	this->legend_version = _smallmap_legend_version;
+}
+
+/**
+ * Invalidate the colour of the group containing a tile.
+ * @param x X coordinate of the tile.
+ * @param y Y coordinate of the tile.
+ */
+void SmallMapColourCache::MarkTileDirty(uint x, uint y)
+{
+	if (this->zoom == 0 || x < this->offset_x || y < this->offset_y) return;
+
+	uint xc = x - (x - this->offset_x) % this->zoom;
+	uint yc = y - (y - this->offset_y) % this->zoom;
+	if (xc / this->zoom >= this->size_x || yc / this->zoom >= this->size_y) return;
+
+	uint index = this->GetIndex(xc, yc);
+	ClrBit(this->valid[index / 32], index % 32);
+}
+
 /** Vehicle colours in #SMT_VEHICLES mode. Indexed by #VehicleTypeByte. */
 static const byte _vehicle_type_colours[6] = {
 	PC_RED, PC_YELLOW, PC_LIGHT_BLUE, PC_WHITE, PC_BLACK, PC_RED
@@ -838,7 +915,13 @@ void SmallMapWindow::DrawSmallMapColumn(void *dst, uint xc, uint yc, int pitch,
 		}
 		ta.ClampToMap(); // Clamp to map boundaries (may contain MP_VOID tiles!).
 
-		uint32 val = this->GetTileColours(ta);
+		uint index = this->colour_cache.GetIndex(xc, yc);
+		if (!HasBit(this->colour_cache.valid[index / 32], index % 32)) {
+			this->colour_cache.colours[index] = this->GetTileColours(ta);
+			SetBit(this->colour_cache.valid[index / 32], index % 32);
+		}
+
+		uint32 val = this->colour_cache.colours[index];
 		uint8 *val8 = (uint8 *)&val;
 		int idx = max(0, -start_pos);
 		for (int pos = max(0, start_pos); pos < end_pos; pos++) {
@@ -966,6 +1049,15 @@ void SmallMapWindow::DrawSmallMap(DrawPixelInfo *dpi) const
 	int tile_x = this->scroll_x / (int)TILE_SIZE + tile.x;
 	int tile_y = this->scroll_y / (int)TILE_SIZE + tile.y;
 
+	/* All tile groups drawn start at the same coordinates modulo the zoom level;
+	 * when those change the cached colours are of different groups. */
+	uint offset_x = (tile_x % this->zoom + this->zoom) % this->zoom;
+	uint offset_y = (tile_y % this->zoom + this->zoom) % this->zoom;
+	if (this->colour_cache.zoom != this->zoom || this->colour_cache.offset_x != offset_x ||
+			this->colour_cache.offset_y != offset_y || this->colour_cache.legend_version != _smallmap_legend_version) {
+		this->colour_cache.Reset(this->zoom, offset_x, offset_y);
+	}
+
 	void *ptr = blitter->MoveTo(dpi->dst_ptr, -dx - 4, 0);
 	int x = - dx - 4;
 	int y = 0;
@@ -1055,8 +1147,10 @@ void SmallMapWindow::SetupWidgetData()
 	this->GetWidget<NWidgetStacked>(WID_SM_SELECT_BUTTONS)->SetDisplayedPlane(plane);
 }
 
-SmallMapWindow::SmallMapWindow(WindowDesc *desc, int window_number) : Window(desc), refresh(FORCE_REFRESH_PERIOD)
+SmallMapWindow::SmallMapWindow(WindowDesc *desc, int window_number) : Window(desc), refresh(FORCE_REFRESH_PERIOD), full_refresh(FULL_REFRESH_COUNT)
 {
+	_smallmap_dirty_tiles_size = MapSize();
+	_smallmap_dirty_tiles = CallocT<uint32>(CeilDiv(_smallmap_dirty_tiles_size, 32));
 	_smallmap_industry_highlight = INVALID_INDUSTRYTYPE;
 	this->overlay = new LinkGraphOverlay(this, WID_SM_MAP, 0, this->GetOverlayCompanyMask(), 1);
 	this->InitNested(window_number);
@@ -1077,6 +1171,10 @@ SmallMapWindow::SmallMapWindow(WindowDesc *desc, int window_number) : Window(des
 
 SmallMapWindow::~SmallMapWindow()
 {
+	free(_smallmap_dirty_tiles);
+	_smallmap_dirty_tiles = NULL;
+	_smallmap_dirty_tiles_size = 0;
+
 	delete this->overlay;
 	this->BreakIndustryChainLink();
 }
@@ -1291,6 +1389,7 @@ void SmallMapWindow::SwitchMapType(SmallMapType map_type)
 
 	if (map_type == SMT_LINKSTATS) this->overlay->RebuildCache();
 	if (map_type != SMT_INDUSTRY) this->BreakIndustryChainLink();
+	this->colour_cache.Clear();
 	this->SetDirty();
 }
 
@@ -1344,6 +1443,7 @@ void SmallMapWindow::SelectLegendItem(int click_pos, LegendAndColour *legend, in
 	}
 
 	if (this->map_type == SMT_INDUSTRY) this->BreakIndustryChainLink();
+	this->colour_cache.Clear();
 }
 
 /**
@@ -1392,6 +1492,7 @@ int SmallMapWindow::GetPositionOnLegend(Point pt)
 		_smallmap_industry_highlight = new_highlight;
 		this->refresh = _smallmap_industry_highlight != INVALID_INDUSTRYTYPE ? BLINK_PERIOD : FORCE_REFRESH_PERIOD;
 		_smallmap_industry_highlight_state = true;
+		this->colour_cache.Clear();
 		this->SetDirty();
 	}
 }
@@ -1500,6 +1601,7 @@ int SmallMapWindow::GetPositionOnLegend(Point pt)
 				tbl->show_on_map = (widget == WID_SM_ENABLE_ALL);
 			}
 			if (this->map_type == SMT_LINKSTATS) this->SetOverlayCargoMask();
+			this->colour_cache.Clear();
 			this->SetDirty();
 			break;
 		}
@@ -1507,6 +1609,7 @@ int SmallMapWindow::GetPositionOnLegend(Point pt)
 		case WID_SM_SHOW_HEIGHT: // Enable/disable showing of heightmap.
 			_smallmap_show_heightmap = !_smallmap_show_heightmap;
 			this->SetWidgetLoweredState(WID_SM_SHOW_HEIGHT, _smallmap_show_heightmap);
+			this->colour_cache.Clear();
 			this->SetDirty();
 			break;
 	}
@@ -1546,6 +1649,7 @@ int SmallMapWindow::GetPositionOnLegend(Point pt)
 
 		default: NOT_REACHED();
 	}
+	this->colour_cache.Clear();
 	this->SetDirty();
 }
 
@@ -1585,10 +1689,39 @@ int SmallMapWindow::GetPositionOnLegend(Point pt)
 	}
 	_smallmap_industry_highlight_state = !_smallmap_industry_highlight_state;
 
+	/* The highlighted industries blink, so their colours change every refresh.
+	 * Otherwise look all tiles up again every now and then, to also catch
+	 * changes of tiles that were not marked dirty. */
+	if (--this->full_refresh == 0) this->full_refresh = FULL_REFRESH_COUNT;
+	if (_smallmap_industry_highlight != INVALID_INDUSTRYTYPE || this->full_refresh == FULL_REFRESH_COUNT) {
+		this->colour_cache.Clear();
+	}
+	/* Also after clearing, to forget the tiles marked dirty in the meantime. */
+	this->ApplyDirtyTiles();
+
 	this->refresh = _smallmap_industry_highlight != INVALID_INDUSTRYTYPE ? BLINK_PERIOD : FORCE_REFRESH_PERIOD;
 	this->SetDirty();
 }
 
+/**
+ * Invalidate the cached colours of all tiles marked dirty since the last refresh.
+ */
+void SmallMapWindow::ApplyDirtyTiles()
+{
+	uint words = CeilDiv(_smallmap_dirty_tiles_size, 32);
+	for (uint i = 0; i < words; i++) {
+		uint32 bits = _smallmap_dirty_tiles[i];
+		if (bits == 0) continue;
+		_smallmap_dirty_tiles[i] = 0;
+
+		uint bit;
+		FOR_EACH_SET_BIT(bit, bits) {
+			TileIndex tile = i * 32 + bit;
+			this->colour_cache.MarkTileDirty(TileX(tile), TileY(tile));
+		}
+	}
+}
+
 /**
  * Set new #scroll_x, #scroll_y, and #subscroll values after limiting them such that the center
  * of the smallmap always contains a part of the map.
@@ -27,6 +27,8 @@ void BuildIndustriesLegend();
 void ShowSmallMap();
 void BuildLandLegend();
 void BuildOwnerLegend();
+uint8 GetSmallMapOwnerColour(TileIndex tile);
+void MarkSmallMapTileDirty(TileIndex tile);
 
 /** Structure for holding relevant data for legends in small map */
 struct LegendAndColour {
@@ -40,6 +42,52 @@ struct LegendAndColour {
 	bool col_break;            ///< Perform a column break and go further at the next column.
 };
 
+/**
+ * Cache of the colours of the groups of tiles that the smallmap draws as one
+ * piece of a pixel column. Groups start at tile coordinates that are the same
+ * modulo the zoom level, so a group is identified by its first tile divided by
+ * the zoom level. Only groups containing tiles marked dirty since the last
+ * refresh have to be looked up again.
+ */
+struct SmallMapColourCache {
+	uint32 *colours;     ///< Colours of each group of tiles.
+	uint32 *valid;       ///< Bitmap of the groups whose entry in #colours is valid.
+	uint size_x;         ///< Number of groups in X direction.
+	uint size_y;         ///< Number of groups in Y direction.
+	int zoom;            ///< Zoom level of the groups, or \c 0 when nothing is cached.
+	uint offset_x;       ///< X coordinate of the first tile of every group, modulo #zoom.
+	uint offset_y;       ///< Y coordinate of the first tile of every group, modulo #zoom.
+	uint legend_version; ///< Version of the legends the colours were looked up with.
+
+	SmallMapColourCache() : colours(NULL), valid(NULL), size_x(0), size_y(0), zoom(0), offset_x(0), offset_y(0), legend_version(0) {}
+
+	~SmallMapColourCache()
+	{
+		free(this->colours);
+		free(this->valid);
+	}
+
+	/** Forget all cached colours. */
+	inline void Clear()
+	{
+		this->zoom = 0;
+	}
+
+	/**
+	 * Get the index of the group starting at the given tile.
+	 * @param xc X coordinate of the first tile of the group.
+	 * @param yc Y coordinate of the first tile of the group.
+	 * @return Index of the group in #colours.
+	 */
+	inline uint GetIndex(uint xc, uint yc) const
+	{
+		return (yc / this->zoom) * this->size_x + xc / this->zoom;
+	}
+
+	void Reset(int zoom, uint offset_x, uint offset_y);
+	void MarkTileDirty(uint x, uint y);
+};
+
 /** Class managing the smallmap window. */
 class SmallMapWindow : public Window {
 protected:
@@ -69,6 +117,7 @@ protected:
 	static const uint INDUSTRY_MIN_NUMBER_OF_COLUMNS = 2; ///< Minimal number of columns in the #WID_SM_LEGEND widget for the #SMT_INDUSTRY legend.
 	static const uint FORCE_REFRESH_PERIOD = 0x1F; ///< map is redrawn after that many ticks
 	static const uint BLINK_PERIOD         = 0x0F; ///< highlight blinking interval
+	static const uint FULL_REFRESH_COUNT   = 8;    ///< number of refreshes after which all tile colours are looked up again
 
 	uint min_number_of_columns;    ///< Minimal number of columns in legends.
 	uint min_number_of_fixed_rows; ///< Minimal number of rows in the legends for the fixed layouts only (all except #SMT_INDUSTRY).
@@ -80,7 +129,9 @@ protected:
 	int zoom;        ///< Zoom level. Bigger number means more zoom-out (further away).
 
 	uint8 refresh;   ///< Refresh counter, zeroed every FORCE_REFRESH_PERIOD ticks.
+	uint8 full_refresh; ///< Counter of refreshes until the next full refresh, see #FULL_REFRESH_COUNT.
 	LinkGraphOverlay *overlay;
+	mutable SmallMapColourCache colour_cache; ///< Colours of the tile groups drawn at the current zoom level and scroll position.
 
 	static void BreakIndustryChainLink();
 	Point SmallmapRemapCoords(int x, int y) const;
@@ -156,6 +207,7 @@ protected:
 
 	void DrawMapIndicators() const;
 	void DrawSmallMapColumn(void *dst, uint xc, uint yc, int pitch, int reps, int start_pos, int end_pos, Blitter *blitter) const;
+	void ApplyDirtyTiles();
 	void DrawVehicles(const DrawPixelInfo *dpi, Blitter *blitter) const;
 	void DrawTowns(const DrawPixelInfo *dpi) const;
 	void DrawSmallMap(DrawPixelInfo *dpi) const;
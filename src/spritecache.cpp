@@ -19,11 +19,15 @@
 #include "blitter/factory.hpp"
 #include "core/math_func.hpp"
 #include "core/mem_func.hpp"
+#include "thread/thread.h"
 
 #include "table/sprites.h"
 #include "table/strings.h"
 #include "table/palette_convert.h"
 
+#include <vector>
+#include <algorithm>
+
 #include "safeguards.h"
 
 /* Default of 4MB spritecache */
@@ -82,6 +86,7 @@ struct MemBlock {
 };
 
 static uint _sprite_lru_counter;
+SpriteCacheStats _sprite_cache_stats; ///< Counters about the use of the sprite cache.
 static MemBlock *_spritecache_ptr;
 static uint _allocated_sprite_cache_size = 0;
 static int _compact_cache_counter;
@@ -397,9 +402,10 @@ static void *ReadRecolourSprite(uint16 file_slot, uint num)
  * @param id          Sprite number.
  * @param sprite_type Type of sprite.
  * @param allocator   Allocator function to use.
+ * @param encoder     Blitter to encode the sprite for, or NULL for the current blitter.
  * @return Read sprite data.
  */
-static void *ReadSprite(const SpriteCache *sc, SpriteID id, SpriteType sprite_type, AllocatorProc *allocator)
+static void *ReadSprite(const SpriteCache *sc, SpriteID id, SpriteType sprite_type, AllocatorProc *allocator, Blitter *encoder)
 {
 	uint8 file_slot = sc->file_slot;
 	size_t file_pos = sc->file_pos;
@@ -414,8 +420,10 @@ static void *ReadSprite(const SpriteCache *sc, SpriteID id, SpriteType sprite_ty
 	uint8 sprite_avail = 0;
 	sprite[ZOOM_LVL_NORMAL].type = sprite_type;
 
+	if (encoder == NULL) encoder = BlitterFactory::GetCurrentBlitter();
+
 	SpriteLoaderGrf sprite_loader(sc->container_ver);
-	if (sprite_type != ST_MAPGEN && BlitterFactory::GetCurrentBlitter()->GetScreenDepth() == 32) {
+	if (sprite_type != ST_MAPGEN && encoder->GetScreenDepth() == 32) {
 		/* Try for 32bpp sprites first. */
 		sprite_avail = sprite_loader.LoadSprite(sprite, file_slot, file_pos, sprite_type, true);
 	}
@@ -426,7 +434,7 @@ static void *ReadSprite(const SpriteCache *sc, SpriteID id, SpriteType sprite_ty
 	if (sprite_avail == 0) {
 		if (sprite_type == ST_MAPGEN) return NULL;
 		if (id == SPR_IMG_QUERY) usererror("Okay... something went horribly wrong. I couldn't load the fallback sprite. What should I do?");
-		return (void*)GetRawSprite(SPR_IMG_QUERY, ST_NORMAL, allocator);
+		return (void*)GetRawSprite(SPR_IMG_QUERY, ST_NORMAL, allocator, encoder);
 	}
 
 	if (sprite_type == ST_MAPGEN) {
@@ -459,7 +467,7 @@ static void *ReadSprite(const SpriteCache *sc, SpriteID id, SpriteType sprite_ty
 
 	if (!ResizeSprites(sprite, sprite_avail, file_slot, sc->id)) {
 		if (id == SPR_IMG_QUERY) usererror("Okay... something went horribly wrong. I couldn't resize the fallback sprite. What should I do?");
-		return (void*)GetRawSprite(SPR_IMG_QUERY, ST_NORMAL, allocator);
+		return (void*)GetRawSprite(SPR_IMG_QUERY, ST_NORMAL, allocator, encoder);
 	}
 
 	if (sprite->type == ST_FONT && ZOOM_LVL_GUI != ZOOM_LVL_NORMAL) {
@@ -471,12 +479,57 @@ static void *ReadSprite(const SpriteCache *sc, SpriteID id, SpriteType sprite_ty
 		sprite[ZOOM_LVL_NORMAL].data   = sprite[ZOOM_LVL_GUI].data;
 	}
 
-	return BlitterFactory::GetCurrentBlitter()->Encode(sprite, allocator);
+	return encoder->Encode(sprite, allocator);
+}
+
+
+/** Sprite numbers with their position in the GRF file, sorted by sprite number. */
+typedef std::vector<std::pair<uint32, size_t> > GRFSpriteOffsets;
+
+static GRFSpriteOffsets _grf_sprite_offsets_read; ///< Sprite offsets read by #ReadGRFSpriteOffsets itself.
+static const GRFSpriteOffsets *_grf_sprite_offsets = &_grf_sprite_offsets_read; ///< Sprite offsets of the GRF that is being processed.
+
+/** State of a #GRFSpriteOffsetsJob. */
+enum GRFSpriteOffsetsJobState {
+	GSOJS_QUEUED,  ///< Nobody is indexing the file yet.
+	GSOJS_RUNNING, ///< A thread is indexing the file.
+	GSOJS_DONE,    ///< The offsets are known.
+};
+
+/** Sprite section of a GRF that is indexed before it is needed, see #PrepareGRFSpriteOffsets. */
+struct GRFSpriteOffsetsJob {
+	const char *filename;           ///< Name of the GRF; the pointer itself identifies the job.
+	Subdirectory subdir;            ///< Sub directory to search the GRF in.
+	GRFSpriteOffsetsJobState state; ///< Whether the offsets are known already.
+	GRFSpriteOffsets offsets;       ///< The offsets of the sprites in the GRF.
+};
+
+static AutoDeleteSmallVector<GRFSpriteOffsetsJob *, 32> _grf_sprite_offsets_jobs; ///< GRFs of which the sprite section is indexed in advance.
+static SmallVector<ThreadObject *, 4> _grf_sprite_offsets_threads; ///< Threads indexing the GRFs in #_grf_sprite_offsets_jobs.
+static ThreadMutex *_grf_sprite_offsets_mutex = NULL; ///< Mutex protecting the state of the jobs.
+
+/** Comparator for sorting #GRFSpriteOffsets on sprite number. */
+static bool GRFSpriteOffsetIDSorter(const std::pair<uint32, size_t> &a, const std::pair<uint32, size_t> &b)
+{
+	return a.first < b.first;
 }
 
+/**
+ * Sort the offsets on sprite number, so they can be searched.
+ * When a sprite number occurs more than once, the last occurrence is used.
+ * @param offsets The offsets in file order.
+ */
+static void SortGRFSpriteOffsets(GRFSpriteOffsets &offsets)
+{
+	std::stable_sort(offsets.begin(), offsets.end(), GRFSpriteOffsetIDSorter);
 
-/** Map from sprite numbers to position in the GRF file. */
-static std::map<uint32, size_t> _grf_sprite_offsets;
+	GRFSpriteOffsets::iterator last = offsets.begin();
+	for (GRFSpriteOffsets::iterator it = offsets.begin(); it != offsets.end(); ++it) {
+		if (it + 1 != offsets.end() && (it + 1)->first == it->first) continue;
+		*last++ = *it;
+	}
+	offsets.erase(last, offsets.end());
+}
 
 /**
  * Get the file offset for a specific sprite in the sprite section of a GRF.
@@ -485,18 +538,190 @@ static std::map<uint32, size_t> _grf_sprite_offsets;
  */
 size_t GetGRFSpriteOffset(uint32 id)
 {
-	return _grf_sprite_offsets.find(id) != _grf_sprite_offsets.end() ? _grf_sprite_offsets[id] : SIZE_MAX;
+	GRFSpriteOffsets::const_iterator it = std::lower_bound(_grf_sprite_offsets->begin(), _grf_sprite_offsets->end(), std::make_pair(id, (size_t)0), GRFSpriteOffsetIDSorter);
+	return it != _grf_sprite_offsets->end() && it->first == id ? it->second : SIZE_MAX;
+}
+
+/**
+ * Read a little endian dword from a file, reading missing bytes as zero.
+ * @param f The file to read from.
+ * @return The read dword.
+ */
+static uint32 ReadDword(FILE *f)
+{
+	byte data[4] = { 0, 0, 0, 0 };
+	if (fread(data, 1, sizeof(data), f) == 0) return 0;
+	return data[0] | data[1] << 8 | data[2] << 16 | data[3] << 24;
+}
+
+/**
+ * Index the sprite section of a GRF with its own file handle, so it can be done by any thread.
+ * This results in the same offsets as #ReadGRFSpriteOffsets.
+ * @param job The GRF to index.
+ */
+static void IndexGRFSpriteOffsets(GRFSpriteOffsetsJob *job)
+{
+	FILE *f = FioFOpenFile(job->filename, "rb", job->subdir);
+	if (f == NULL) return;
+
+	/* Only container version 2 has a sprite section. */
+	extern const byte _grf_cont_v2_sig[8];
+	byte header[2 + 8];
+	if (fread(header, 1, sizeof(header), f) == sizeof(header) && header[0] == 0 && header[1] == 0 && MemCmpT(header + 2, _grf_cont_v2_sig, 8) == 0) {
+		size_t data_offset = ReadDword(f);
+		if (fseek(f, data_offset, SEEK_CUR) == 0) {
+			uint32 id, prev_id = 0;
+			while ((id = ReadDword(f)) != 0) {
+				if (id != prev_id) job->offsets.push_back(std::make_pair(id, (size_t)ftell(f) - 4));
+				prev_id = id;
+				if (fseek(f, ReadDword(f), SEEK_CUR) != 0) break;
+			}
+			SortGRFSpriteOffsets(job->offsets);
+		}
+	}
+
+	FioFCloseFile(f);
+}
+
+/**
+ * Index GRFs until there are no queued jobs left.
+ * @param param Not used.
+ */
+static void GRFSpriteOffsetsThreadProc(void *param)
+{
+	for (;;) {
+		GRFSpriteOffsetsJob *job = NULL;
+
+		_grf_sprite_offsets_mutex->BeginCritical();
+		for (GRFSpriteOffsetsJob **it = _grf_sprite_offsets_jobs.Begin(); it != _grf_sprite_offsets_jobs.End(); it++) {
+			if ((*it)->state == GSOJS_QUEUED) {
+				job = *it;
+				job->state = GSOJS_RUNNING;
+				break;
+			}
+		}
+		_grf_sprite_offsets_mutex->EndCritical();
+
+		if (job == NULL) return;
+		IndexGRFSpriteOffsets(job);
+
+		_grf_sprite_offsets_mutex->BeginCritical();
+		job->state = GSOJS_DONE;
+		_grf_sprite_offsets_mutex->SendSignal();
+		_grf_sprite_offsets_mutex->EndCritical();
+	}
+}
+
+/**
+ * Queue a GRF to have its sprite section indexed in advance, so #ReadGRFSpriteOffsets does not have to.
+ * @param filename Name of the GRF; the same pointer has to be passed to #ReadGRFSpriteOffsets.
+ * @param subdir Sub directory to search the GRF in.
+ * @see StartPreparingGRFSpriteOffsets
+ */
+void PrepareGRFSpriteOffsets(const char *filename, Subdirectory subdir)
+{
+	assert(_grf_sprite_offsets_threads.Length() == 0);
+
+	GRFSpriteOffsetsJob *job = new GRFSpriteOffsetsJob();
+	job->filename = filename;
+	job->subdir = subdir;
+	job->state = GSOJS_QUEUED;
+	*_grf_sprite_offsets_jobs.Append() = job;
+}
+
+/**
+ * Start indexing the queued GRFs in background threads, when there are cores to spare.
+ * GRFs that are still queued when they are needed are indexed by the calling thread.
+ */
+void StartPreparingGRFSpriteOffsets()
+{
+	if (_grf_sprite_offsets_mutex == NULL) _grf_sprite_offsets_mutex = ThreadMutex::New();
+	if (GetCPUCoreCount() <= 1) return;
+
+	uint threads = min(GetCPUCoreCount() - 1, 4U);
+	for (uint i = 0; i < threads && i < _grf_sprite_offsets_jobs.Length(); i++) {
+		ThreadObject *thread;
+		if (!ThreadObject::New(&GRFSpriteOffsetsThreadProc, NULL, &thread, "ottd:grf-index")) break;
+		*_grf_sprite_offsets_threads.Append() = thread;
+	}
+}
+
+/** Stop indexing GRFs in advance and free the prepared offsets. */
+void ClearPreparedGRFSpriteOffsets()
+{
+	if (_grf_sprite_offsets_mutex != NULL) {
+		/* Prevent the threads from starting on other GRFs. */
+		_grf_sprite_offsets_mutex->BeginCritical();
+		for (GRFSpriteOffsetsJob **it = _grf_sprite_offsets_jobs.Begin(); it != _grf_sprite_offsets_jobs.End(); it++) {
+			if ((*it)->state == GSOJS_QUEUED) (*it)->state = GSOJS_DONE;
+		}
+		_grf_sprite_offsets_mutex->EndCritical();
+	}
+
+	for (ThreadObject **it = _grf_sprite_offsets_threads.Begin(); it != _grf_sprite_offsets_threads.End(); it++) {
+		(*it)->Join();
+		delete *it;
+	}
+	_grf_sprite_offsets_threads.Clear();
+
+	_grf_sprite_offsets = &_grf_sprite_offsets_read;
+	_grf_sprite_offsets_jobs.Clear();
+}
+
+/**
+ * Get the prepared offsets of a GRF, waiting for them or indexing the GRF when needed.
+ * @param filename Name of the GRF, as passed to #PrepareGRFSpriteOffsets.
+ * @param subdir Sub directory to search the GRF in.
+ * @return The offsets, or \c NULL when this GRF was not queued.
+ */
+static const GRFSpriteOffsets *GetPreparedGRFSpriteOffsets(const char *filename, Subdirectory subdir)
+{
+	if (_grf_sprite_offsets_mutex == NULL) return NULL;
+
+	GRFSpriteOffsetsJob *job = NULL;
+	for (GRFSpriteOffsetsJob **it = _grf_sprite_offsets_jobs.Begin(); it != _grf_sprite_offsets_jobs.End(); it++) {
+		if ((*it)->filename == filename && (*it)->subdir == subdir) {
+			job = *it;
+			break;
+		}
+	}
+	if (job == NULL) return NULL;
+
+	_grf_sprite_offsets_mutex->BeginCritical();
+	if (job->state == GSOJS_QUEUED) {
+		/* No thread got to it yet, so do it ourselves. */
+		job->state = GSOJS_RUNNING;
+		_grf_sprite_offsets_mutex->EndCritical();
+		IndexGRFSpriteOffsets(job);
+		_grf_sprite_offsets_mutex->BeginCritical();
+		job->state = GSOJS_DONE;
+	}
+	while (job->state != GSOJS_DONE) _grf_sprite_offsets_mutex->WaitForSignal();
+	_grf_sprite_offsets_mutex->EndCritical();
+
+	return &job->offsets;
 }
 
 /**
  * Parse the sprite section of GRFs.
  * @param container_version Container version of the GRF we're currently processing.
+ * @param filename Name of the GRF, when its sprite section might have been prepared by #PrepareGRFSpriteOffsets.
+ * @param subdir Sub directory the GRF was found in.
  */
-void ReadGRFSpriteOffsets(byte container_version)
+void ReadGRFSpriteOffsets(byte container_version, const char *filename, Subdirectory subdir)
 {
-	_grf_sprite_offsets.clear();
+	_grf_sprite_offsets_read.clear();
+	_grf_sprite_offsets = &_grf_sprite_offsets_read;
 
 	if (container_version >= 2) {
+		const GRFSpriteOffsets *prepared = filename != NULL ? GetPreparedGRFSpriteOffsets(filename, subdir) : NULL;
+		if (prepared != NULL) {
+			/* Only skip the sprite section offset. */
+			FioReadDword();
+			_grf_sprite_offsets = prepared;
+			return;
+		}
+
 		/* Seek to sprite section of the GRF. */
 		size_t data_offset = FioReadDword();
 		size_t old_pos = FioGetPos();
@@ -506,10 +731,11 @@ void ReadGRFSpriteOffsets(byte container_version)
 		 * offset for each newly encountered ID. */
 		uint32 id, prev_id = 0;
 		while ((id = FioReadDword()) != 0) {
-			if (id != prev_id) _grf_sprite_offsets[id] = FioGetPos() - 4;
+			if (id != prev_id) _grf_sprite_offsets_read.push_back(std::make_pair(id, FioGetPos() - 4));
 			prev_id = id;
 			FioSkipBytes(FioReadDword());
 		}
+		SortGRFSpriteOffsets(_grf_sprite_offsets_read);
 
 		/* Continue processing the data section. */
 		FioSeekTo(old_pos, SEEK_SET);
@@ -677,8 +903,11 @@ static void CompactSpriteCache()
 			MemBlock temp;
 			SpriteID i;
 
-			/* Since free blocks are automatically coalesced, this should hold true. */
-			assert(!(next->size & S_FREE_MASK));
+			/* Free blocks are only coalesced lazily, so do that first. */
+			if (next->size & S_FREE_MASK) {
+				s->size += next->size & ~S_FREE_MASK;
+				continue;
+			}
 
 			/* If the next block is the sentinel block, we can safely return */
 			if (next->size == 0) break;
@@ -707,6 +936,9 @@ static void CompactSpriteCache()
 
 /**
  * Delete a single entry from the sprite cache.
+ * Adjacent free blocks are not coalesced here, as that means walking all
+ * blocks for every deleted entry; #AllocSprite and #CompactSpriteCache
+ * coalesce the free blocks they come across instead.
  * @param item Entry to delete.
  */
 static void DeleteEntryFromSpriteCache(uint item)
@@ -716,15 +948,6 @@ static void DeleteEntryFromSpriteCache(uint item)
 	assert(!(s->size & S_FREE_MASK));
 	s->size |= S_FREE_MASK;
 	GetSpriteCache(item)->ptr = NULL;
-
-	/* And coalesce adjacent free blocks */
-	for (s = _spritecache_ptr; s->size != 0; s = NextBlock(s)) {
-		if (s->size & S_FREE_MASK) {
-			while (NextBlock(s)->size & S_FREE_MASK) {
-				s->size += NextBlock(s)->size & ~S_FREE_MASK;
-			}
-		}
-	}
 }
 
 static void DeleteEntryFromSpriteCache()
@@ -748,6 +971,7 @@ static void DeleteEntryFromSpriteCache()
 	if (best == UINT_MAX) error("Out of sprite memory");
 
 	DeleteEntryFromSpriteCache(best);
+	_sprite_cache_stats.evictions++;
 }
 
 static void *AllocSprite(size_t mem_req)
@@ -763,6 +987,11 @@ static void *AllocSprite(size_t mem_req)
 
 		for (s = _spritecache_ptr; s->size != 0; s = NextBlock(s)) {
 			if (s->size & S_FREE_MASK) {
+				/* Coalesce with the free blocks following this one. */
+				while (NextBlock(s)->size & S_FREE_MASK) {
+					s->size += NextBlock(s)->size & ~S_FREE_MASK;
+				}
+
 				size_t cur_size = s->size & ~S_FREE_MASK;
 
 				/* Is the block exactly the size we need or
@@ -793,10 +1022,11 @@ static void *AllocSprite(size_t mem_req)
  * @param sprite ID of loaded sprite
  * @param requested requested sprite type
  * @param sc the currently known sprite cache for the requested sprite
+ * @param encoder Blitter to encode the sprite for, or NULL for the current blitter.
  * @return fallback sprite
  * @note this function will do usererror() in the case the fallback sprite isn't available
  */
-static void *HandleInvalidSpriteRequest(SpriteID sprite, SpriteType requested, SpriteCache *sc, AllocatorProc *allocator)
+static void *HandleInvalidSpriteRequest(SpriteID sprite, SpriteType requested, SpriteCache *sc, AllocatorProc *allocator, Blitter *encoder)
 {
 	static const char * const sprite_types[] = {
 		"normal",        // ST_NORMAL
@@ -808,7 +1038,7 @@ static void *HandleInvalidSpriteRequest(SpriteID sprite, SpriteType requested, S
 	SpriteType available = sc->type;
 	if (requested == ST_FONT && available == ST_NORMAL) {
 		if (sc->ptr == NULL) sc->type = ST_FONT;
-		return GetRawSprite(sprite, sc->type, allocator);
+		return GetRawSprite(sprite, sc->type, allocator, encoder);
 	}
 
 	byte warning_level = sc->warned ? 6 : 0;
@@ -820,10 +1050,10 @@ static void *HandleInvalidSpriteRequest(SpriteID sprite, SpriteType requested, S
 			if (sprite == SPR_IMG_QUERY) usererror("Uhm, would you be so kind not to load a NewGRF that makes the 'query' sprite a non-normal sprite?");
 			FALLTHROUGH;
 		case ST_FONT:
-			return GetRawSprite(SPR_IMG_QUERY, ST_NORMAL, allocator);
+			return GetRawSprite(SPR_IMG_QUERY, ST_NORMAL, allocator, encoder);
 		case ST_RECOLOUR:
 			if (sprite == PALETTE_TO_DARK_BLUE) usererror("Uhm, would you be so kind not to load a NewGRF that makes the 'PALETTE_TO_DARK_BLUE' sprite a non-remap sprite?");
-			return GetRawSprite(PALETTE_TO_DARK_BLUE, ST_RECOLOUR, allocator);
+			return GetRawSprite(PALETTE_TO_DARK_BLUE, ST_RECOLOUR, allocator, encoder);
 		case ST_MAPGEN:
 			/* this shouldn't happen, overriding of ST_MAPGEN sprites is checked in LoadNextSprite()
 			 * (the only case the check fails is when these sprites weren't even loaded...) */
@@ -838,12 +1068,14 @@ static void *HandleInvalidSpriteRequest(SpriteID sprite, SpriteType requested, S
  * @param sprite Sprite to read.
  * @param type Expected sprite type.
  * @param allocator Allocator function to use. Set to NULL to use the usual sprite cache.
+ * @param encoder Blitter to encode the sprite for; NULL for the current blitter. Another blitter requires an allocator.
  * @return Sprite raw data
  */
-void *GetRawSprite(SpriteID sprite, SpriteType type, AllocatorProc *allocator)
+void *GetRawSprite(SpriteID sprite, SpriteType type, AllocatorProc *allocator, Blitter *encoder)
 {
 	assert(type != ST_MAPGEN || IsMapgenSpriteID(sprite));
 	assert(type < ST_INVALID);
+	assert(allocator != NULL || encoder == NULL);
 
 	if (!SpriteExists(sprite)) {
 		DEBUG(sprite, 1, "Tried to load non-existing sprite #%d. Probable cause: Wrong/missing NewGRFs", sprite);
@@ -854,7 +1086,7 @@ void *GetRawSprite(SpriteID sprite, SpriteType type, AllocatorProc *allocator)
 
 	SpriteCache *sc = GetSpriteCache(sprite);
 
-	if (sc->type != type) return HandleInvalidSpriteRequest(sprite, type, sc, allocator);
+	if (sc->type != type) return HandleInvalidSpriteRequest(sprite, type, sc, allocator, encoder);
 
 	if (allocator == NULL) {
 		/* Load sprite into/from spritecache */
@@ -863,12 +1095,17 @@ void *GetRawSprite(SpriteID sprite, SpriteType type, AllocatorProc *allocator)
 		sc->lru = ++_sprite_lru_counter;
 
 		/* Load the sprite, if it is not loaded, yet */
-		if (sc->ptr == NULL) sc->ptr = ReadSprite(sc, sprite, type, AllocSprite);
+		if (sc->ptr == NULL) {
+			_sprite_cache_stats.misses++;
+			sc->ptr = ReadSprite(sc, sprite, type, AllocSprite, NULL);
+		} else {
+			_sprite_cache_stats.hits++;
+		}
 
 		return sc->ptr;
 	} else {
 		/* Do not use the spritecache, but a different allocator. */
-		return ReadSprite(sc, sprite, type, allocator);
+		return ReadSprite(sc, sprite, type, allocator, encoder);
 	}
 }
 
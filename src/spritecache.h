@@ -13,6 +13,9 @@
 #define SPRITECACHE_H
 
 #include "gfx_type.h"
+#include "fileio_type.h"
+
+class Blitter;
 
 /** Data structure describing a sprite. */
 struct Sprite {
@@ -23,11 +26,19 @@ struct Sprite {
 	byte data[];   ///< Sprite data.
 };
 
+/** Counters about the use of the sprite cache. */
+struct SpriteCacheStats {
+	uint64 hits;      ///< Number of requested sprites that were in the cache already.
+	uint64 misses;    ///< Number of requested sprites that had to be loaded into the cache.
+	uint64 evictions; ///< Number of sprites removed from the cache to make room for others.
+};
+
 extern uint _sprite_cache_size;
+extern SpriteCacheStats _sprite_cache_stats;
 
 typedef void *AllocatorProc(size_t size);
 
-void *GetRawSprite(SpriteID sprite, SpriteType type, AllocatorProc *allocator = NULL);
+void *GetRawSprite(SpriteID sprite, SpriteType type, AllocatorProc *allocator = NULL, Blitter *encoder = NULL);
 bool SpriteExists(SpriteID sprite);
 
 SpriteType GetSpriteType(SpriteID sprite);
@@ -52,7 +63,10 @@ void GfxInitSpriteMem();
 void GfxClearSpriteCache();
 void IncreaseSpriteLRU();
 
-void ReadGRFSpriteOffsets(byte container_version);
+void PrepareGRFSpriteOffsets(const char *filename, Subdirectory subdir);
+void StartPreparingGRFSpriteOffsets();
+void ClearPreparedGRFSpriteOffsets();
+void ReadGRFSpriteOffsets(byte container_version, const char *filename = NULL, Subdirectory subdir = NO_DIRECTORY);
 size_t GetGRFSpriteOffset(uint32 id);
 bool LoadNextSprite(int load_index, byte file_index, uint file_sprite_id, byte container_version);
 bool SkipSpriteData(byte type, uint16 num);
@@ -108,6 +108,13 @@ Station::~Station()
 		}
 	}
 
+	/* Make sure no industry keeps delivering to this station. */
+	Industry *i;
+	FOR_ALL_INDUSTRIES(i) {
+		Station **st = i->stations_near.Find(this);
+		if (st != i->stations_near.End()) i->stations_near.ErasePreservingOrder(st);
+	}
+
 	Vehicle *v;
 	FOR_ALL_VEHICLES(v) {
 		/* Forget about this station if this station is removed */
@@ -380,6 +387,42 @@ void Station::RecomputeIndustriesNear()
 	FOR_ALL_STATIONS(st) st->RecomputeIndustriesNear();
 }
 
+/**
+ * Check whether the station may cover (part of) the production area of
+ * the given industry, i.e. whether the station's tile rectangle intersects
+ * the industry's location grown by the largest catchment radius in use.
+ * @param ind The industry to check.
+ * @return True if the industry may deliver its production to this station.
+ */
+bool Station::MayServeIndustry(const Industry *ind) const
+{
+	if (this->rect.IsEmpty()) return false;
+
+	int rad = _settings_game.station.modified_catchment ? MAX_CATCHMENT : CA_UNMODIFIED;
+	int x = TileX(ind->location.tile);
+	int y = TileY(ind->location.tile);
+
+	return this->rect.left < x + ind->location.w + rad && this->rect.right >= x - rad &&
+			this->rect.top < y + ind->location.h + rad && this->rect.bottom >= y - rad;
+}
+
+/**
+ * Recomputes the catchment caches after the station's tiles or its
+ * catchment radius changed. This updates the list of industries the
+ * station delivers to, as well as Industry::stations_near of all
+ * industries that are, or used to be, covered by the station.
+ */
+void Station::RecomputeCatchment()
+{
+	this->RecomputeIndustriesNear();
+
+	Industry *i;
+	FOR_ALL_INDUSTRIES(i) {
+		if (i->location.w == 0) continue;
+		if (i->stations_near.Contains(this) || this->MayServeIndustry(i)) i->RecomputeStationsNear();
+	}
+}
+
 /************************************************************************/
 /*                     StationRect implementation                       */
 /************************************************************************/
@@ -487,6 +487,8 @@ public:
 	/* virtual */ uint GetPlatformLength(TileIndex tile) const;
 	void RecomputeIndustriesNear();
 	static void RecomputeIndustriesNearForAll();
+	void RecomputeCatchment();
+	bool MayServeIndustry(const Industry *ind) const;
 
 	uint GetCatchmentRadius() const;
 	Rect GetCatchmentRect() const;
@@ -1401,7 +1401,7 @@ CommandCost CmdBuildRailStation(TileIndex tile_org, DoCommandFlag flags, uint32
 		st->MarkTilesDirty(false);
 		st->UpdateVirtCoord();
 		UpdateStationAcceptance(st, false);
-		st->RecomputeIndustriesNear();
+		st->RecomputeCatchment();
 		InvalidateWindowData(WC_SELECT_STATION, 0, 0);
 		InvalidateWindowData(WC_STATION_LIST, st->owner, 0);
 		SetWindowWidgetDirty(WC_STATION_VIEW, st->index, WID_SV_TRAINS);
@@ -1599,7 +1599,7 @@ CommandCost CmdRemoveFromRailStation(TileIndex start, DoCommandFlag flags, uint3
 
 		if (st->train_station.tile == INVALID_TILE) SetWindowWidgetDirty(WC_STATION_VIEW, st->index, WID_SV_TRAINS);
 		st->MarkTilesDirty(false);
-		st->RecomputeIndustriesNear();
+		st->RecomputeCatchment();
 	}
 
 	/* Now apply the rail cost to the number that we deleted */
@@ -1682,7 +1682,7 @@ static CommandCost RemoveRailStation(TileIndex tile, DoCommandFlag flags)
 	Station *st = Station::GetByTile(tile);
 	CommandCost cost = RemoveRailStation(st, flags, _price[PR_CLEAR_STATION_RAIL]);
 
-	if (flags & DC_EXEC) st->RecomputeIndustriesNear();
+	if (flags & DC_EXEC) st->RecomputeCatchment();
 
 	return cost;
 }
@@ -1874,7 +1874,7 @@ CommandCost CmdBuildRoadStop(TileIndex tile, DoCommandFlag flags, uint32 p1, uin
 	if (st != NULL) {
 		st->UpdateVirtCoord();
 		UpdateStationAcceptance(st, false);
-		st->RecomputeIndustriesNear();
+		st->RecomputeCatchment();
 		InvalidateWindowData(WC_SELECT_STATION, 0, 0);
 		InvalidateWindowData(WC_STATION_LIST, st->owner, 0);
 		SetWindowWidgetDirty(WC_STATION_VIEW, st->index, WID_SV_ROADVEHS);
@@ -1987,7 +1987,7 @@ static CommandCost RemoveRoadStop(TileIndex tile, DoCommandFlag flags)
 		st->rect.AfterRemoveTile(st, tile);
 
 		st->UpdateVirtCoord();
-		st->RecomputeIndustriesNear();
+		st->RecomputeCatchment();
 		DeleteStationIfEmpty(st);
 
 		/* Update the tile area of the truck/bus stop */
@@ -2304,7 +2304,7 @@ CommandCost CmdBuildAirport(TileIndex tile, DoCommandFlag flags, uint32 p1, uint
 
 		st->UpdateVirtCoord();
 		UpdateStationAcceptance(st, false);
-		st->RecomputeIndustriesNear();
+		st->RecomputeCatchment();
 		InvalidateWindowData(WC_SELECT_STATION, 0, 0);
 		InvalidateWindowData(WC_STATION_LIST, st->owner, 0);
 		InvalidateWindowData(WC_STATION_VIEW, st->index, -1);
@@ -2393,7 +2393,7 @@ static CommandCost RemoveAirport(TileIndex tile, DoCommandFlag flags)
 		DirtyCompanyInfrastructureWindows(st->owner);
 
 		st->UpdateVirtCoord();
-		st->RecomputeIndustriesNear();
+		st->RecomputeCatchment();
 		DeleteStationIfEmpty(st);
 		DeleteNewGRFInspectWindow(GSF_AIRPORTS, st->index);
 	}
@@ -2544,7 +2544,7 @@ CommandCost CmdBuildDock(TileIndex tile, DoCommandFlag flags, uint32 p1, uint32
 
 		st->UpdateVirtCoord();
 		UpdateStationAcceptance(st, false);
-		st->RecomputeIndustriesNear();
+		st->RecomputeCatchment();
 		InvalidateWindowData(WC_SELECT_STATION, 0, 0);
 		InvalidateWindowData(WC_STATION_LIST, st->owner, 0);
 		SetWindowWidgetDirty(WC_STATION_VIEW, st->index, WID_SV_SHIPS);
@@ -2590,7 +2590,7 @@ static CommandCost RemoveDock(TileIndex tile, DoCommandFlag flags)
 
 		SetWindowWidgetDirty(WC_STATION_VIEW, st->index, WID_SV_SHIPS);
 		st->UpdateVirtCoord();
-		st->RecomputeIndustriesNear();
+		st->RecomputeCatchment();
 		DeleteStationIfEmpty(st);
 
 		/* All ships that were going to our station, can't go to it anymore.
@@ -3927,7 +3927,7 @@ void BuildOilRig(TileIndex tile)
 
 	st->UpdateVirtCoord();
 	UpdateStationAcceptance(st, false);
-	st->RecomputeIndustriesNear();
+	st->RecomputeCatchment();
 }
 
 void DeleteOilRig(TileIndex tile)
@@ -3944,7 +3944,7 @@ void DeleteOilRig(TileIndex tile)
 	st->rect.AfterRemoveTile(st, tile);
 
 	st->UpdateVirtCoord();
-	st->RecomputeIndustriesNear();
+	st->RecomputeCatchment();
 	if (!st->IsInUse()) delete st;
 }
 
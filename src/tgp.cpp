@@ -228,12 +228,12 @@ static height_t TGPGetMaxHeight()
 	 * around the mountain to build on. On a 4096x4096 map, it won't cover any major part of the map.
 	 */
 	static const int max_height[5][MAX_MAP_SIZE_BITS - MIN_MAP_SIZE_BITS + 1] = {
-		/* 64  128  256  512 1024 2048 4096 */
-		{   3,   3,   3,   3,   4,   5,   7 }, ///< Very flat
-		{   5,   7,   8,   9,  14,  19,  31 }, ///< Flat
-		{   8,   9,  10,  15,  23,  37,  61 }, ///< Hilly
-		{  10,  11,  17,  19,  49,  63,  73 }, ///< Mountainous
-		{  12,  19,  25,  31,  67,  75,  87 }, ///< Alpinist
+		/* 64  128  256  512 1024 2048 4096 8192 16384 */
+		{   3,   3,   3,   3,   4,   5,   7,   8,   9 }, ///< Very flat
+		{   5,   7,   8,   9,  14,  19,  31,  31,  31 }, ///< Flat
+		{   8,   9,  10,  15,  23,  37,  61,  61,  61 }, ///< Hilly
+		{  10,  11,  17,  19,  49,  63,  73,  73,  73 }, ///< Mountainous
+		{  12,  19,  25,  31,  67,  75,  87,  87,  87 }, ///< Alpinist
 	};
 
 	int max_height_from_table = max_height[_settings_game.difficulty.terrain_type][min(MapLogX(), MapLogY()) - MIN_MAP_SIZE_BITS];
@@ -365,9 +365,10 @@ byte VehicleRandomBits()
 	return GB(Random(), 0, 8);
 }
 
-/* Size of the hash, 6 = 64 x 64, 7 = 128 x 128. Larger sizes will (in theory) reduce hash
- * lookup times at the expense of memory usage. */
-const int HASH_BITS = 7;
+/* Size of the hash, 6 = 64 x 64, 7 = 128 x 128, 8 = 256 x 256. Larger sizes will (in theory) reduce hash
+ * lookup times at the expense of memory usage. The hash wraps around, so on large maps more
+ * tiles share a bucket; 256 x 256 keeps the buckets short on maps beyond 4096 x 4096. */
+const int HASH_BITS = 8;
 const int HASH_SIZE = 1 << HASH_BITS;
 const int HASH_MASK = HASH_SIZE - 1;
 const int TOTAL_HASH_SIZE = 1 << (HASH_BITS * 2);
@@ -921,7 +922,7 @@ static void RunVehicleDayProc()
 
 		/* Call the 32-day callback if needed */
 		if ((v->day_counter & 0x1F) == 0 && v->HasEngineType()) {
-			uint16 callback = GetVehicleCallback(CBID_VEHICLE_32DAY_CALLBACK, 0, 0, v->engine_type, v);
+			uint16 callback = GetVehicle32DayCallback(v);
 			if (callback != CALLBACK_FAILED) {
 				if (HasBit(callback, 0)) {
 					TriggerVehicle(v, VEHICLE_TRIGGER_CALLBACK_32); // Trigger vehicle trigger 10
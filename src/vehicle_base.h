@@ -74,6 +74,63 @@ struct NewGRFCache {
 	uint8  cache_valid;               ///< Bitset that indicates which cache values are valid.
 };
 
+/**
+ * Cache of parameterised NewGRF variables that only depend on the composition of the consist.
+ * Like #NewGRFCache it is emptied whenever the consist changes, but it is not part of the cache check.
+ */
+struct NewGRFVariableCache {
+	static const uint SIZE = 4; ///< Number of variables that can be cached at the same time.
+
+	/** A single cached variable. */
+	struct Entry {
+		uint32 parameter; ///< Parameter of the variable.
+		uint32 value;     ///< Value of the variable.
+		byte variable;    ///< Number of the variable.
+	};
+
+	Entry entries[SIZE]; ///< The cached variables.
+	uint8 count;         ///< Number of valid entries.
+	uint8 next;          ///< Entry to replace when all entries are in use.
+
+	/**
+	 * Find a cached variable.
+	 * @param variable Number of the variable.
+	 * @param parameter Parameter of the variable.
+	 * @param[out] value Cached value of the variable, when found.
+	 * @return Whether the variable is cached.
+	 */
+	inline bool Find(byte variable, uint32 parameter, uint32 *value) const
+	{
+		for (uint i = 0; i < this->count; i++) {
+			if (this->entries[i].variable == variable && this->entries[i].parameter == parameter) {
+				*value = this->entries[i].value;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * Add a variable to the cache, replacing the oldest one when the cache is full.
+	 * @param variable Number of the variable.
+	 * @param parameter Parameter of the variable.
+	 * @param value Value of the variable.
+	 */
+	inline void Store(byte variable, uint32 parameter, uint32 value)
+	{
+		Entry *e;
+		if (this->count < SIZE) {
+			e = &this->entries[this->count++];
+		} else {
+			e = &this->entries[this->next];
+			this->next = (this->next + 1) % SIZE;
+		}
+		e->variable = variable;
+		e->parameter = parameter;
+		e->value = value;
+	}
+};
+
 /** Meaning of the various bits of the visual effect. */
 enum VisualEffect {
 	VE_OFFSET_START        = 0, ///< First bit that contains the offset (0 = front, 8 = centre, 15 = rear)
@@ -327,6 +384,7 @@ public:
 	byte subtype;                       ///< subtype (Filled with values from #EffectVehicles/#TrainSubTypes/#AircraftSubTypes)
 
 	NewGRFCache grf_cache;              ///< Cache of often used calculated NewGRF values
+	NewGRFVariableCache grf_var_cache;  ///< Cache of parameterised NewGRF variables that depend on the consist.
 	VehicleCache vcache;                ///< Cache of often used vehicle values.
 
 	Vehicle(VehicleType type = VEH_INVALID);
@@ -451,6 +509,8 @@ public:
 	inline void InvalidateNewGRFCache()
 	{
 		this->grf_cache.cache_valid = 0;
+		this->grf_var_cache.count = 0;
+		this->grf_var_cache.next = 0;
 	}
 
 	/**
@@ -88,6 +88,10 @@
 #include "command_func.h"
 #include "network/network_func.h"
 #include "framerate_type.h"
+#include "thread/thread.h"
+#include "core/sort_func.hpp"
+#include "smallmap_gui.h"
+#include "newgrf_profiling.h"
 
 #include <map>
 
@@ -171,6 +175,10 @@ struct ViewportDrawer {
 	FoundationPart foundation_part;                  ///< Currently active foundation for ground sprite drawing.
 	int *last_foundation_child[FOUNDATION_PART_END]; ///< Tail of ChildSprite list of the foundations. (index into child_screen_sprites_to_draw)
 	Point foundation_offset[FOUNDATION_PART_END];    ///< Pixel offset for ground sprites on the foundations.
+
+	bool recording_tile;                             ///< Whether the sprites of the current tile are being recorded for the tile sprite cache.
+	bool recording_failed;                           ///< Whether the current tile turned out not to be cacheable while recording it.
+	SmallVector<Rect, 16> parent_sprite_extents;     ///< Screen extents of the parent sprites of the tile being recorded.
 };
 
 static void MarkViewportDirty(const ViewPort *vp, int left, int top, int right, int bottom);
@@ -631,7 +639,11 @@ void OffsetGroundSprite(int x, int y)
 	}
 
 	/* _vd.last_child == NULL if foundation sprite was clipped by the viewport bounds */
-	if (_vd.last_child != NULL) _vd.foundation[_vd.foundation_part] = _vd.parent_sprites_to_draw.Length() - 1;
+	if (_vd.last_child != NULL) {
+		_vd.foundation[_vd.foundation_part] = _vd.parent_sprites_to_draw.Length() - 1;
+	}
+	/* Without a parent sprite of the recorded tile, the foundation is one of a previous tile. */
+	if (_vd.recording_tile && _vd.parent_sprite_extents.Length() == 0) _vd.recording_failed = true;
 
 	_vd.foundation_offset[_vd.foundation_part].x = x * ZOOM_LVL_BASE;
 	_vd.foundation_offset[_vd.foundation_part].y = y * ZOOM_LVL_BASE;
@@ -733,11 +745,19 @@ void AddSortableSpriteToDraw(SpriteID image, PaletteID pal, int x, int y, int w,
 		bottom = max(bottom, RemapCoords(x + w          , y + h          , z + bb_offset_z).y + 1);
 	}
 
-	/* Do not add the sprite to the viewport, if it is outside */
-	if (left   >= _vd.dpi.left + _vd.dpi.width ||
-	    right  <= _vd.dpi.left                 ||
-	    top    >= _vd.dpi.top + _vd.dpi.height ||
-	    bottom <= _vd.dpi.top) {
+	if (_vd.recording_tile) {
+		/* Keep the sprite regardless of the viewport area; whether it is
+		 * visible is decided each time the cached tile is drawn. */
+		Rect *extent = _vd.parent_sprite_extents.Append();
+		extent->left = left;
+		extent->top = top;
+		extent->right = right;
+		extent->bottom = bottom;
+	} else if (left   >= _vd.dpi.left + _vd.dpi.width ||
+	           right  <= _vd.dpi.left                 ||
+	           top    >= _vd.dpi.top + _vd.dpi.height ||
+	           bottom <= _vd.dpi.top) {
+		/* Do not add the sprite to the viewport, if it is outside */
 		return;
 	}
 
@@ -789,6 +809,8 @@ void AddSortableSpriteToDraw(SpriteID image, PaletteID pal, int x, int y, int w,
 void StartSpriteCombine()
 {
 	assert(_vd.combine_sprites == SPRITE_COMBINE_NONE);
+	/* Which sprite becomes the combined parent depends on the viewport area. */
+	if (_vd.recording_tile) _vd.recording_failed = true;
 	_vd.combine_sprites = SPRITE_COMBINE_PENDING;
 }
 
@@ -848,6 +870,9 @@ void AddChildSpriteScreen(SpriteID image, PaletteID pal, int x, int y, bool tran
 {
 	assert((image & SPRITE_MASK) < MAX_SPRITES);
 
+	/* Without a parent sprite of the recorded tile, this child belongs to a previous tile. */
+	if (_vd.recording_tile && _vd.parent_sprite_extents.Length() == 0) _vd.recording_failed = true;
+
 	/* If the ParentSprite was clipped by the viewport bounds, do not draw the ChildSprites either */
 	if (_vd.last_child == NULL) return;
 
@@ -1093,6 +1118,398 @@ static int GetViewportY(Point tile)
 	return (tile.y * (int)(TILE_PIXELS / 2) + tile.x * (int)(TILE_PIXELS / 2) - TilePixelHeightOutsideMap(tile.x, tile.y)) << ZOOM_LVL_SHIFT;
 }
 
+/** Zoom levels from which on the landscape is drawn through the tile sprite cache. */
+static const ZoomLevel VP_TILE_CACHE_MIN_ZOOM = ZOOM_LVL_OUT_8X;
+static const uint VP_TILE_CACHE_CHUNK_BITS = 4;                             ///< Log2 of the width and height of a chunk of the tile sprite cache, in tiles.
+static const uint VP_TILE_CACHE_CHUNK_SIZE = 1 << VP_TILE_CACHE_CHUNK_BITS; ///< Width and height of a chunk of the tile sprite cache, in tiles.
+static const size_t VP_TILE_CACHE_BUDGET = 64 << 20;                        ///< Memory the tile sprite cache may use over all zoom levels, in bytes.
+
+/** Parent sprite of a cached tile. */
+struct CachedParentSprite {
+	ParentSpriteToDraw ps; ///< The sprite; its first child is relative to the first child sprite of its tile.
+	Rect extent;           ///< Screen extent deciding whether the sprite is visible in a viewport area.
+};
+
+/** The sprites a tile added to the viewport, as indices into the lists of its chunk. */
+struct CachedTileRecord {
+	uint32 first_tile_sprite;                     ///< First tile sprite of the tile.
+	uint32 first_parent_sprite;                   ///< First parent sprite of the tile.
+	uint32 first_child_sprite;                    ///< First child sprite of the tile; the children are linked relative to this.
+	uint16 num_tile_sprites;                      ///< Number of tile sprites of the tile.
+	uint16 num_parent_sprites;                    ///< Number of parent sprites of the tile.
+	uint16 num_child_sprites;                     ///< Number of child sprites of the tile.
+	bool valid;                                   ///< Whether the sprites are recorded and up to date.
+	bool uncacheable;                             ///< Whether the tile has to be drawn directly until it is invalidated.
+	FoundationPart foundation_part;               ///< Foundation part active after drawing the tile.
+	int16 foundation[FOUNDATION_PART_END];        ///< Foundation parent sprites, relative to #first_parent_sprite, or -1.
+	Point foundation_offset[FOUNDATION_PART_END]; ///< Pixel offset for ground sprites on the foundations.
+};
+
+/** The cached sprites of a square of tiles for one zoom level. */
+struct CachedTileChunk {
+	CachedTileRecord tiles[VP_TILE_CACHE_CHUNK_SIZE * VP_TILE_CACHE_CHUNK_SIZE]; ///< Records of the tiles in the chunk.
+	TileSpriteToDrawVector tile_sprites;                                        ///< Tile sprites of all records.
+	SmallVector<CachedParentSprite, 16> parent_sprites;                         ///< Parent sprites of all records.
+	ChildScreenSpriteToDrawVector child_sprites;                                ///< Child sprites of all records.
+	uint garbage;                                                               ///< Number of sprites in the lists belonging to invalidated records.
+	uint last_used;                                                             ///< Value of #_vp_tile_cache_frame when the chunk was last drawn.
+	size_t memory;                                                              ///< Memory accounted for this chunk in #_vp_tile_cache_memory.
+
+	CachedTileChunk() : garbage(0), last_used(0), memory(0)
+	{
+		memset(this->tiles, 0, sizeof(this->tiles));
+	}
+
+	/**
+	 * Get the memory used by this chunk.
+	 * @return Size in bytes.
+	 */
+	size_t GetMemoryUsage() const
+	{
+		return sizeof(*this) + this->tile_sprites.Length() * sizeof(TileSpriteToDraw) +
+				this->parent_sprites.Length() * sizeof(CachedParentSprite) +
+				this->child_sprites.Length() * sizeof(ChildScreenSpriteToDraw);
+	}
+};
+
+/** Tile sprite cache of one zoom level. */
+struct ViewportTileCache {
+	CachedTileChunk **chunks; ///< Chunks covering the map, row by row; \c NULL for chunks without cached tiles.
+	uint size_x;              ///< Number of chunks along the X axis.
+	uint size_y;              ///< Number of chunks along the Y axis.
+};
+
+static ViewportTileCache _vp_tile_cache[ZOOM_LVL_COUNT]; ///< Tile sprite cache per zoom level.
+static size_t _vp_tile_cache_memory = 0;                 ///< Memory used by all chunks of the tile sprite cache.
+static uint _vp_tile_cache_frame = 0;                    ///< Counter increased for every drawn viewport area.
+
+/**
+ * Throw away all cached tile sprites, e.g. because settings affecting the
+ * drawing of all tiles changed or a new map is about to be used.
+ */
+void ClearViewportTileCache()
+{
+	for (ZoomLevel zoom = ZOOM_LVL_BEGIN; zoom != ZOOM_LVL_END; zoom++) {
+		ViewportTileCache &cache = _vp_tile_cache[zoom];
+		if (cache.chunks == NULL) continue;
+
+		for (uint i = 0; i < cache.size_x * cache.size_y; i++) delete cache.chunks[i];
+		free(cache.chunks);
+		cache.chunks = NULL;
+	}
+	_vp_tile_cache_memory = 0;
+}
+
+/**
+ * Remove all chunks that were not drawn in the current viewport area.
+ */
+static void EvictViewportTileCache()
+{
+	for (ZoomLevel zoom = ZOOM_LVL_BEGIN; zoom != ZOOM_LVL_END; zoom++) {
+		ViewportTileCache &cache = _vp_tile_cache[zoom];
+		if (cache.chunks == NULL) continue;
+
+		for (uint i = 0; i < cache.size_x * cache.size_y; i++) {
+			CachedTileChunk *chunk = cache.chunks[i];
+			if (chunk == NULL || chunk->last_used == _vp_tile_cache_frame) continue;
+
+			_vp_tile_cache_memory -= chunk->memory;
+			delete chunk;
+			cache.chunks[i] = NULL;
+		}
+	}
+}
+
+/**
+ * Get the chunk of the tile sprite cache for a tile, creating it when needed.
+ * @param zoom Zoom level the tile is drawn at.
+ * @param tile The tile.
+ * @return The chunk, or \c NULL when the tile has to be drawn directly.
+ */
+static CachedTileChunk *GetViewportTileCacheChunk(ZoomLevel zoom, TileIndex tile)
+{
+	if (zoom < VP_TILE_CACHE_MIN_ZOOM) return NULL;
+
+	ViewportTileCache &cache = _vp_tile_cache[zoom];
+	if (cache.chunks != NULL && (cache.size_x << VP_TILE_CACHE_CHUNK_BITS != MapSizeX() || cache.size_y << VP_TILE_CACHE_CHUNK_BITS != MapSizeY())) {
+		ClearViewportTileCache();
+	}
+	if (cache.chunks == NULL) {
+		cache.size_x = MapSizeX() >> VP_TILE_CACHE_CHUNK_BITS;
+		cache.size_y = MapSizeY() >> VP_TILE_CACHE_CHUNK_BITS;
+		cache.chunks = CallocT<CachedTileChunk *>(cache.size_x * cache.size_y);
+	}
+
+	CachedTileChunk *&chunk = cache.chunks[(TileY(tile) >> VP_TILE_CACHE_CHUNK_BITS) * cache.size_x + (TileX(tile) >> VP_TILE_CACHE_CHUNK_BITS)];
+	if (chunk == NULL) {
+		if (_vp_tile_cache_memory + sizeof(CachedTileChunk) > VP_TILE_CACHE_BUDGET) EvictViewportTileCache();
+		if (_vp_tile_cache_memory + sizeof(CachedTileChunk) > VP_TILE_CACHE_BUDGET) return NULL;
+
+		chunk = new CachedTileChunk();
+		chunk->memory = chunk->GetMemoryUsage();
+		_vp_tile_cache_memory += chunk->memory;
+	}
+	chunk->last_used = _vp_tile_cache_frame;
+	return chunk;
+}
+
+/**
+ * Get the record of a tile within its chunk.
+ * @param chunk The chunk of the tile.
+ * @param tile  The tile.
+ * @return The record.
+ */
+static inline CachedTileRecord *GetCachedTileRecord(CachedTileChunk *chunk, TileIndex tile)
+{
+	static const uint mask = VP_TILE_CACHE_CHUNK_SIZE - 1;
+	return &chunk->tiles[((TileY(tile) & mask) << VP_TILE_CACHE_CHUNK_BITS) | (TileX(tile) & mask)];
+}
+
+/**
+ * Throw away the sprites of invalidated records of a chunk.
+ * @param chunk The chunk to compact.
+ */
+static void CompactCachedTileChunk(CachedTileChunk *chunk)
+{
+	TileSpriteToDrawVector tile_sprites;
+	SmallVector<CachedParentSprite, 16> parent_sprites;
+	ChildScreenSpriteToDrawVector child_sprites;
+
+	for (uint i = 0; i < lengthof(chunk->tiles); i++) {
+		CachedTileRecord *rec = &chunk->tiles[i];
+		if (!rec->valid) continue;
+
+		uint first_tile_sprite = tile_sprites.Length();
+		uint first_parent_sprite = parent_sprites.Length();
+		uint first_child_sprite = child_sprites.Length();
+		if (rec->num_tile_sprites != 0) MemCpyT(tile_sprites.Append(rec->num_tile_sprites), chunk->tile_sprites.Get(rec->first_tile_sprite), rec->num_tile_sprites);
+		if (rec->num_parent_sprites != 0) MemCpyT(parent_sprites.Append(rec->num_parent_sprites), chunk->parent_sprites.Get(rec->first_parent_sprite), rec->num_parent_sprites);
+		if (rec->num_child_sprites != 0) MemCpyT(child_sprites.Append(rec->num_child_sprites), chunk->child_sprites.Get(rec->first_child_sprite), rec->num_child_sprites);
+		rec->first_tile_sprite = first_tile_sprite;
+		rec->first_parent_sprite = first_parent_sprite;
+		rec->first_child_sprite = first_child_sprite;
+	}
+
+	chunk->tile_sprites.Swap(tile_sprites);
+	chunk->parent_sprites.Swap(parent_sprites);
+	chunk->child_sprites.Swap(child_sprites);
+	chunk->garbage = 0;
+}
+
+/**
+ * Invalidate the cached sprites of a tile on all zoom levels.
+ * @param x X coordinate of the tile; may be outside of the map.
+ * @param y Y coordinate of the tile; may be outside of the map.
+ */
+static void InvalidateCachedTile(int x, int y)
+{
+	if (!IsInsideBS(x, 0, MapSizeX()) || !IsInsideBS(y, 0, MapSizeY())) return;
+
+	TileIndex tile = TileXY(x, y);
+	for (ZoomLevel zoom = VP_TILE_CACHE_MIN_ZOOM; zoom != ZOOM_LVL_END; zoom++) {
+		const ViewportTileCache &cache = _vp_tile_cache[zoom];
+		if (cache.chunks == NULL || cache.size_x << VP_TILE_CACHE_CHUNK_BITS != MapSizeX() || cache.size_y << VP_TILE_CACHE_CHUNK_BITS != MapSizeY()) continue;
+
+		CachedTileChunk *chunk = cache.chunks[(y >> VP_TILE_CACHE_CHUNK_BITS) * cache.size_x + (x >> VP_TILE_CACHE_CHUNK_BITS)];
+		if (chunk == NULL) continue;
+
+		CachedTileRecord *rec = GetCachedTileRecord(chunk, tile);
+		if (rec->valid) chunk->garbage += rec->num_tile_sprites + rec->num_parent_sprites + rec->num_child_sprites;
+		rec->valid = false;
+		rec->uncacheable = false;
+	}
+}
+
+/**
+ * Invalidate the cached sprites of a tile and its neighbours, as the
+ * drawing of a tile may depend on the tiles around it.
+ * @param x X coordinate of the tile; may be outside of the map.
+ * @param y Y coordinate of the tile; may be outside of the map.
+ */
+static void InvalidateCachedTilesAround(int x, int y)
+{
+	if (_vp_tile_cache_memory == 0) return;
+
+	for (int dy = -1; dy <= 1; dy++) {
+		for (int dx = -1; dx <= 1; dx++) {
+			InvalidateCachedTile(x + dx, y + dy);
+		}
+	}
+}
+
+/**
+ * Add the sprites recorded for a tile to the viewport, dropping the parent
+ * sprites (and their children) that are outside of the viewport area.
+ * @param chunk The chunk of the tile.
+ * @param rec   The record of the tile.
+ */
+static void ViewportAddCachedTile(const CachedTileChunk *chunk, const CachedTileRecord *rec)
+{
+	if (rec->num_tile_sprites != 0) MemCpyT(_vd.tile_sprites_to_draw.Append(rec->num_tile_sprites), chunk->tile_sprites.Get(rec->first_tile_sprite), rec->num_tile_sprites);
+
+	_vd.foundation_part = rec->foundation_part;
+	for (uint part = 0; part < FOUNDATION_PART_END; part++) {
+		_vd.foundation[part] = -1;
+		_vd.last_foundation_child[part] = NULL;
+		_vd.foundation_offset[part] = rec->foundation_offset[part];
+	}
+	if (rec->num_parent_sprites == 0) return;
+
+	const ChildScreenSpriteToDraw *children = chunk->child_sprites.Get(rec->first_child_sprite);
+	int last_parent = -1;
+	for (uint i = 0; i < rec->num_parent_sprites; i++) {
+		const CachedParentSprite *cps = chunk->parent_sprites.Get(rec->first_parent_sprite + i);
+		last_parent = -1;
+
+		if (cps->extent.left   >= _vd.dpi.left + _vd.dpi.width ||
+		    cps->extent.right  <= _vd.dpi.left                 ||
+		    cps->extent.top    >= _vd.dpi.top + _vd.dpi.height ||
+		    cps->extent.bottom <= _vd.dpi.top) {
+			continue;
+		}
+
+		last_parent = _vd.parent_sprites_to_draw.Length();
+		ParentSpriteToDraw *ps = _vd.parent_sprites_to_draw.Append();
+		*ps = cps->ps;
+		ps->first_child = -1;
+
+		int *next = &ps->first_child;
+		for (int child = cps->ps.first_child; child >= 0; child = children[child].next) {
+			*next = _vd.child_screen_sprites_to_draw.Length();
+			ChildScreenSpriteToDraw *cs = _vd.child_screen_sprites_to_draw.Append();
+			*cs = children[child];
+			cs->next = -1;
+			next = &cs->next;
+		}
+
+		for (uint part = 0; part < FOUNDATION_PART_END; part++) {
+			if (rec->foundation[part] == (int)i) _vd.foundation[part] = last_parent;
+		}
+	}
+
+	/* Point to the ends of the child lists only now, as appending children may move them. */
+	for (uint part = 0; part < FOUNDATION_PART_END; part++) {
+		if (_vd.foundation[part] == -1) continue;
+
+		int *next = &_vd.parent_sprites_to_draw.Get(_vd.foundation[part])->first_child;
+		while (*next >= 0) next = &_vd.child_screen_sprites_to_draw.Get(*next)->next;
+		_vd.last_foundation_child[part] = next;
+	}
+	if (last_parent >= 0) {
+		int *next = &_vd.parent_sprites_to_draw.Get(last_parent)->first_child;
+		while (*next >= 0) next = &_vd.child_screen_sprites_to_draw.Get(*next)->next;
+		_vd.last_child = next;
+	} else {
+		_vd.last_child = NULL;
+	}
+}
+
+/**
+ * Add the sprites of a tile to the viewport by calling its draw proc, and
+ * record them in the tile sprite cache.
+ * @param chunk     The chunk of the tile.
+ * @param rec       The record of the tile.
+ * @param ti        Information about the tile.
+ * @param tile_type The type of the tile.
+ */
+static void ViewportRecordTile(CachedTileChunk *chunk, CachedTileRecord *rec, TileInfo *ti, TileType tile_type)
+{
+	uint first_tile_sprite = _vd.tile_sprites_to_draw.Length();
+	uint first_parent_sprite = _vd.parent_sprites_to_draw.Length();
+	uint first_child_sprite = _vd.child_screen_sprites_to_draw.Length();
+	int *last_child = _vd.last_child;
+	uint64 resolve_count = _sprite_group_resolve_count;
+
+	_vd.recording_tile = true;
+	_vd.recording_failed = false;
+	_vd.parent_sprite_extents.Clear();
+
+	_tile_type_procs[tile_type]->draw_tile_proc(ti);
+
+	_vd.recording_tile = false;
+
+	uint num_tile_sprites = _vd.tile_sprites_to_draw.Length() - first_tile_sprite;
+	uint num_parent_sprites = _vd.parent_sprites_to_draw.Length() - first_parent_sprite;
+	uint num_child_sprites = _vd.child_screen_sprites_to_draw.Length() - first_child_sprite;
+
+	/* NewGRF sprites may depend on the date, the town, random bits and the
+	 * like, which change without the tile being marked dirty. So tiles that
+	 * needed any sprite group to be drawn are never cached. */
+	if (resolve_count != _sprite_group_resolve_count) _vd.recording_failed = true;
+
+	if (_vd.recording_failed || max(num_tile_sprites, max(num_parent_sprites, num_child_sprites)) > UINT16_MAX) {
+		/* Keep the sprites as drawn, together with the foundation and child
+		 * state the draw proc left. The only difference with drawing the tile
+		 * directly are the parent sprites outside of the viewport area that
+		 * were not dropped, which are clipped when drawing anyway. */
+		rec->uncacheable = true;
+		return;
+	}
+
+	/* Forget what was drawn; it is added again from the record. */
+	_vd.tile_sprites_to_draw.Resize(first_tile_sprite);
+	_vd.parent_sprites_to_draw.Resize(first_parent_sprite);
+	_vd.child_screen_sprites_to_draw.Resize(first_child_sprite);
+
+	rec->first_tile_sprite = chunk->tile_sprites.Length();
+	rec->first_parent_sprite = chunk->parent_sprites.Length();
+	rec->first_child_sprite = chunk->child_sprites.Length();
+	rec->num_tile_sprites = num_tile_sprites;
+	rec->num_parent_sprites = num_parent_sprites;
+	rec->num_child_sprites = num_child_sprites;
+	rec->foundation_part = _vd.foundation_part;
+	for (uint part = 0; part < FOUNDATION_PART_END; part++) {
+		rec->foundation[part] = _vd.foundation[part] == -1 ? -1 : _vd.foundation[part] - first_parent_sprite;
+		rec->foundation_offset[part] = _vd.foundation_offset[part];
+	}
+
+	if (num_tile_sprites != 0) MemCpyT(chunk->tile_sprites.Append(num_tile_sprites), _vd.tile_sprites_to_draw.Get(first_tile_sprite), num_tile_sprites);
+	for (uint i = 0; i < num_parent_sprites; i++) {
+		CachedParentSprite *cps = chunk->parent_sprites.Append();
+		cps->ps = *_vd.parent_sprites_to_draw.Get(first_parent_sprite + i);
+		if (cps->ps.first_child >= 0) cps->ps.first_child -= first_child_sprite;
+		cps->extent = *_vd.parent_sprite_extents.Get(i);
+	}
+	for (uint i = 0; i < num_child_sprites; i++) {
+		ChildScreenSpriteToDraw *cs = chunk->child_sprites.Append();
+		*cs = *_vd.child_screen_sprites_to_draw.Get(first_child_sprite + i);
+		if (cs->next >= 0) cs->next -= first_child_sprite;
+	}
+	rec->valid = true;
+
+	if (chunk->garbage > VP_TILE_CACHE_CHUNK_SIZE * VP_TILE_CACHE_CHUNK_SIZE &&
+			chunk->garbage > chunk->tile_sprites.Length() + chunk->parent_sprites.Length() + chunk->child_sprites.Length() - chunk->garbage) {
+		CompactCachedTileChunk(chunk);
+	}
+
+	size_t memory = chunk->GetMemoryUsage();
+	_vp_tile_cache_memory += memory - chunk->memory;
+	chunk->memory = memory;
+
+	_vd.last_child = last_child;
+	ViewportAddCachedTile(chunk, rec);
+}
+
+/**
+ * Add the sprites of a tile to the viewport, from the tile sprite cache
+ * when the tile is drawn zoomed out far enough.
+ * @param ti        Information about the tile.
+ * @param tile_type The type of the tile.
+ */
+static void ViewportAddTile(TileInfo *ti, TileType tile_type)
+{
+	CachedTileChunk *chunk = ti->tile == INVALID_TILE ? NULL : GetViewportTileCacheChunk(_vd.dpi.zoom, ti->tile);
+	CachedTileRecord *rec = chunk == NULL ? NULL : GetCachedTileRecord(chunk, ti->tile);
+
+	if (rec == NULL || rec->uncacheable) {
+		_tile_type_procs[tile_type]->draw_tile_proc(ti);
+	} else if (!rec->valid) {
+		ViewportRecordTile(chunk, rec, ti, tile_type);
+	} else {
+		ViewportAddCachedTile(chunk, rec);
+	}
+}
+
 /**
  * Add the landscape to the viewport, i.e. all ground tiles and buildings.
  */
@@ -1203,7 +1620,7 @@ static void ViewportAddLandscape()
 				_vd.last_foundation_child[0] = NULL;
 				_vd.last_foundation_child[1] = NULL;
 
-				_tile_type_procs[tile_type]->draw_tile_proc(&tile_info);
+				ViewportAddTile(&tile_info, tile_type);
 				if (tile_info.tile != INVALID_TILE) DrawTileSelection(&tile_info);
 			}
 		}
@@ -1437,6 +1854,203 @@ static void ViewportSortParentSprites(ParentSpriteToSortVector *psdv)
 	}
 }
 
+/** Minimum number of parent sprites for which #ViewportSortParentSpritesBucketed looks up sprites in buckets. */
+static const uint VP_SORTER_BUCKET_MIN_SPRITES = 128;
+/** Log2 of the depth (x + y) covered by one row of buckets of #ViewportSortParentSpritesBucketed; one tile. */
+static const uint VP_SORTER_BUCKET_ROW_SHIFT = 4;
+
+/** Sorter used by #ViewportSortParentSpritesBucketed for short lists. */
+static VpSpriteSorter _vp_small_sprite_sorter = &ViewportSortParentSprites;
+
+/** Parent sprite as stored in the buckets of #ViewportSortParentSpritesBucketed. */
+struct SpriteSortBucketEntry {
+	int32 row;    ///< Row of buckets: (xmin + ymin) >> #VP_SORTER_BUCKET_ROW_SHIFT.
+	int32 column; ///< Screen column within the row: xmin - ymin.
+	int32 depth;  ///< xmin + ymin.
+	int32 xmin;   ///< Minimal world X coordinate of the bounding box.
+	int32 ymin;   ///< Minimal world Y coordinate of the bounding box.
+	int32 zmin;   ///< Minimal world Z coordinate of the bounding box.
+	uint index;   ///< Index of the sprite in the list to sort.
+};
+
+/** Sprite that has been moved to the front of the list. */
+struct SpriteSortMove {
+	int key;    ///< Position in the list at the time of the move.
+	uint index; ///< Index of the sprite in the list to sort.
+};
+
+/** Sort bucket entries by row, then by column. */
+static int CDECL SpriteSortBucketEntrySorter(const SpriteSortBucketEntry *a, const SpriteSortBucketEntry *b)
+{
+	if (a->row != b->row) return a->row < b->row ? -1 : 1;
+	if (a->column != b->column) return a->column < b->column ? -1 : 1;
+	return 0;
+}
+
+/** Sort moves by their position in the list. */
+static int CDECL SpriteSortMoveSorter(const SpriteSortMove *a, const SpriteSortMove *b)
+{
+	return a->key - b->key;
+}
+
+/**
+ * Check whether a parent sprite has to be moved in front of another one,
+ * using the same comparison as #ViewportSortParentSprites.
+ * @param ps  The sprite at the front of the list.
+ * @param ps2 A later sprite.
+ * @return True if \a ps2 has to be drawn before \a ps.
+ */
+static inline bool ViewportSpriteGoesBefore(const ParentSpriteToDraw *ps, const ParentSpriteToDraw *ps2)
+{
+	if (ps->xmax >= ps2->xmin && ps->xmin <= ps2->xmax && // overlap in X?
+			ps->ymax >= ps2->ymin && ps->ymin <= ps2->ymax && // overlap in Y?
+			ps->zmax >= ps2->zmin && ps->zmin <= ps2->zmax) { // overlap in Z?
+		return ps->xmin + ps->xmax + ps->ymin + ps->ymax + ps->zmin + ps->zmax >
+				ps2->xmin + ps2->xmax + ps2->ymin + ps2->ymax + ps2->zmin + ps2->zmax;
+	}
+	return !(ps->xmax < ps2->xmin || ps->ymax < ps2->ymin || ps->zmax < ps2->zmin);
+}
+
+/** The bucketed sprite sorter always exists. */
+static bool ViewportSortParentSpritesBucketedChecker()
+{
+	return true;
+}
+
+/**
+ * Sort parent sprites pointer array into exactly the same order as
+ * #ViewportSortParentSprites, without comparing every pair of sprites.
+ *
+ * The pairwise sorter takes the first sprite that was not compared yet and
+ * moves all later sprites that have to be drawn before it to the front, in
+ * list order, making the last one moved the next sprite to compare. A sprite
+ * is final once it has been compared and is at the front.
+ *
+ * A sprite can only have to be drawn before the front sprite when its
+ * xmin <= front.xmax and its ymin <= front.ymax. So the sprites are put
+ * into rows of buckets by xmin + ymin and sorted by screen column within a
+ * row, and only the rows up to front.xmax + front.ymax and the range of
+ * columns that can satisfy both conditions are looked at. Moving sprites to
+ * the front is done by giving them ever lower keys on a stack, instead of
+ * shifting the list.
+ * @param psdv The sprites to sort.
+ */
+static void ViewportSortParentSpritesBucketed(ParentSpriteToSortVector *psdv)
+{
+	const uint n = psdv->Length();
+	if (n < VP_SORTER_BUCKET_MIN_SPRITES) {
+		_vp_small_sprite_sorter(psdv);
+		return;
+	}
+
+	SmallVector<ParentSpriteToDraw *, 64> sprites;
+	SmallVector<int, 64> keys;  // Position of each sprite in the list; sprites never moved keep their index.
+	SmallVector<bool, 64> done; // Whether each sprite has been compared with the later ones.
+	SmallVector<SpriteSortBucketEntry, 64> buckets;
+	MemCpyT(sprites.Append(n), psdv->Begin(), n);
+	for (uint i = 0; i < n; i++) {
+		const ParentSpriteToDraw *ps = sprites[i];
+		*keys.Append() = i;
+		*done.Append() = false;
+
+		SpriteSortBucketEntry *entry = buckets.Append();
+		entry->depth = ps->xmin + ps->ymin;
+		entry->row = entry->depth >> VP_SORTER_BUCKET_ROW_SHIFT;
+		entry->column = ps->xmin - ps->ymin;
+		entry->xmin = ps->xmin;
+		entry->ymin = ps->ymin;
+		entry->zmin = ps->zmin;
+		entry->index = i;
+	}
+	QSortT(buckets.Begin(), n, &SpriteSortBucketEntrySorter);
+
+	/* First bucket entry of each row, plus the end of the last row. */
+	const int min_row = buckets[0].row;
+	const int max_row = buckets[n - 1].row;
+	SmallVector<uint, 64> row_start;
+	for (int row = min_row, j = 0; row <= max_row + 1; row++) {
+		while (j < (int)n && buckets[j].row < row) j++;
+		*row_start.Append() = j;
+	}
+
+	SmallVector<SpriteSortMove, 64> stack; // Sprites moved to the front; the front is at the end.
+	SmallVector<SpriteSortMove, 16> moves;
+	uint out = 0;        // Number of sprites that are final.
+	uint first = 0;      // First bucket entry that may not be done.
+	uint unmoved = 0;    // First sprite that may still be at its original position.
+	int next_key = -1;
+	for (;;) {
+		/* Find the front of the list; sprites that were moved again have stale entries on the stack. */
+		while (stack.Length() != 0 && keys[stack.End()[-1].index] != stack.End()[-1].key) stack.Erase(stack.End() - 1);
+
+		uint front;
+		if (stack.Length() != 0) {
+			front = stack.End()[-1].index;
+		} else {
+			while (unmoved < n && keys[unmoved] < 0) unmoved++;
+			if (unmoved == n) break;
+			front = unmoved;
+		}
+
+		if (done[front]) {
+			(*psdv)[out++] = sprites[front];
+			if (stack.Length() != 0) {
+				stack.Erase(stack.End() - 1);
+			} else {
+				unmoved++;
+			}
+			continue;
+		}
+
+		ParentSpriteToDraw *ps = sprites[front];
+		ps->comparison_done = true;
+		done[front] = true;
+
+		while (first < n && done[buckets[first].index]) first++;
+		if (first == n) continue;
+
+		moves.Clear();
+		const int limit = ps->xmax + ps->ymax;
+		const int last_row = min(limit >> VP_SORTER_BUCKET_ROW_SHIFT, max_row);
+		for (int row = buckets[first].row; row <= last_row; row++) {
+			/* Columns for which xmin <= ps->xmax and ymin <= ps->ymax are possible in this row. */
+			const int row_depth = row << VP_SORTER_BUCKET_ROW_SHIFT;
+			const int min_column = row_depth - 2 * ps->ymax;
+			const int max_column = 2 * ps->xmax - row_depth;
+
+			uint lo = max(first, row_start[row - min_row]);
+			uint end = row_start[row - min_row + 1];
+			for (uint hi = end; lo < hi;) {
+				uint mid = (lo + hi) / 2;
+				if (buckets[mid].column < min_column) {
+					lo = mid + 1;
+				} else {
+					hi = mid;
+				}
+			}
+
+			for (uint j = lo; j < end && buckets[j].column <= max_column; j++) {
+				const SpriteSortBucketEntry &entry = buckets[j];
+				if (entry.depth > limit || entry.xmin > ps->xmax || entry.ymin > ps->ymax || entry.zmin > ps->zmax) continue;
+				if (done[entry.index] || !ViewportSpriteGoesBefore(ps, sprites[entry.index])) continue;
+
+				SpriteSortMove *move = moves.Append();
+				move->key = keys[entry.index];
+				move->index = entry.index;
+			}
+		}
+
+		/* Move them to the front in list order, so the last one ends up in front. */
+		QSortT(moves.Begin(), moves.Length(), &SpriteSortMoveSorter);
+		for (const SpriteSortMove *move = moves.Begin(); move != moves.End(); move++) {
+			SpriteSortMove *top = stack.Append();
+			top->index = move->index;
+			top->key = keys[move->index] = next_key--;
+		}
+	}
+	assert(out == n);
+}
+
 static void ViewportDrawParentSprites(const ParentSpriteToSortVector *psd, const ChildScreenSpriteToDrawVector *csstdv)
 {
 	const ParentSpriteToDraw * const *psd_end = psd->End();
@@ -1533,7 +2147,16 @@ static void ViewportDrawStrings(ZoomLevel zoom, const StringSpriteToDrawVector *
 	}
 }
 
-void ViewportDoDraw(const ViewPort *vp, int left, int top, int right, int bottom)
+/**
+ * Collect all sprites of the given viewport area into #_vd and fill its
+ * list of parent sprites to sort. Nothing is drawn yet.
+ * @param vp     The viewport to collect the sprites of.
+ * @param left   Left edge of the area, in virtual viewport coordinates.
+ * @param top    Top edge of the area, in virtual viewport coordinates.
+ * @param right  Right edge of the area, in virtual viewport coordinates.
+ * @param bottom Bottom edge of the area, in virtual viewport coordinates.
+ */
+static void ViewportCollectSprites(const ViewPort *vp, int left, int top, int right, int bottom)
 {
 	DrawPixelInfo *old_dpi = _cur_dpi;
 	_cur_dpi = &_vd.dpi;
@@ -1549,6 +2172,7 @@ void ViewportDoDraw(const ViewPort *vp, int left, int top, int right, int bottom
 	_vd.dpi.top = top & mask;
 	_vd.dpi.pitch = old_dpi->pitch;
 	_vd.last_child = NULL;
+	_vp_tile_cache_frame++;
 
 	int x = UnScaleByZoom(_vd.dpi.left - (vp->virtual_left & mask), vp->zoom) + vp->left;
 	int y = UnScaleByZoom(_vd.dpi.top - (vp->virtual_top & mask), vp->zoom) + vp->top;
@@ -1564,21 +2188,38 @@ void ViewportDoDraw(const ViewPort *vp, int left, int top, int right, int bottom
 
 	DrawTextEffects(&_vd.dpi);
 
-	if (_vd.tile_sprites_to_draw.Length() != 0) ViewportDrawTileSprites(&_vd.tile_sprites_to_draw);
-
 	ParentSpriteToDraw *psd_end = _vd.parent_sprites_to_draw.End();
 	for (ParentSpriteToDraw *it = _vd.parent_sprites_to_draw.Begin(); it != psd_end; it++) {
 		*_vd.parent_sprites_to_sort.Append() = it;
 	}
 
-	_vp_sprite_sorter(&_vd.parent_sprites_to_sort);
-	ViewportDrawParentSprites(&_vd.parent_sprites_to_sort, &_vd.child_screen_sprites_to_draw);
+	_cur_dpi = old_dpi;
+}
+
+/**
+ * Draw the sprites collected by #ViewportCollectSprites, after their parent
+ * sprites have been sorted, and empty the drawer for the next area.
+ * @param vd The drawer holding the collected and sorted sprites.
+ * @param vp The viewport the sprites were collected for.
+ */
+static void ViewportDrawCollectedSprites(ViewportDrawer &vd, const ViewPort *vp)
+{
+	DrawPixelInfo *old_dpi = _cur_dpi;
+	_cur_dpi = &vd.dpi;
 
-	if (_draw_bounding_boxes) ViewportDrawBoundingBoxes(&_vd.parent_sprites_to_sort);
+	int mask = ScaleByZoom(-1, vp->zoom);
+	int x = UnScaleByZoom(vd.dpi.left - (vp->virtual_left & mask), vp->zoom) + vp->left;
+	int y = UnScaleByZoom(vd.dpi.top - (vp->virtual_top & mask), vp->zoom) + vp->top;
+
+	if (vd.tile_sprites_to_draw.Length() != 0) ViewportDrawTileSprites(&vd.tile_sprites_to_draw);
+
+	ViewportDrawParentSprites(&vd.parent_sprites_to_sort, &vd.child_screen_sprites_to_draw);
+
+	if (_draw_bounding_boxes) ViewportDrawBoundingBoxes(&vd.parent_sprites_to_sort);
 	if (_draw_dirty_blocks) ViewportDrawDirtyBlocks();
 
-	DrawPixelInfo dp = _vd.dpi;
-	ZoomLevel zoom = _vd.dpi.zoom;
+	DrawPixelInfo dp = vd.dpi;
+	ZoomLevel zoom = vd.dpi.zoom;
 	dp.zoom = ZOOM_LVL_NORMAL;
 	dp.width = UnScaleByZoom(dp.width, zoom);
 	dp.height = UnScaleByZoom(dp.height, zoom);
@@ -1591,20 +2232,171 @@ void ViewportDoDraw(const ViewPort *vp, int left, int top, int right, int bottom
 		vp->overlay->Draw(&dp);
 	}
 
-	if (_vd.string_sprites_to_draw.Length() != 0) {
+	if (vd.string_sprites_to_draw.Length() != 0) {
 		/* translate to world coordinates */
-		dp.left = UnScaleByZoom(_vd.dpi.left, zoom);
-		dp.top = UnScaleByZoom(_vd.dpi.top, zoom);
-		ViewportDrawStrings(zoom, &_vd.string_sprites_to_draw);
+		dp.left = UnScaleByZoom(vd.dpi.left, zoom);
+		dp.top = UnScaleByZoom(vd.dpi.top, zoom);
+		ViewportDrawStrings(zoom, &vd.string_sprites_to_draw);
 	}
 
 	_cur_dpi = old_dpi;
 
-	_vd.string_sprites_to_draw.Clear();
-	_vd.tile_sprites_to_draw.Clear();
-	_vd.parent_sprites_to_draw.Clear();
-	_vd.parent_sprites_to_sort.Clear();
-	_vd.child_screen_sprites_to_draw.Clear();
+	vd.string_sprites_to_draw.Clear();
+	vd.tile_sprites_to_draw.Clear();
+	vd.parent_sprites_to_draw.Clear();
+	vd.parent_sprites_to_sort.Clear();
+	vd.child_screen_sprites_to_draw.Clear();
+}
+
+void ViewportDoDraw(const ViewPort *vp, int left, int top, int right, int bottom)
+{
+	ViewportCollectSprites(vp, left, top, right, bottom);
+	_vp_sprite_sorter(&_vd.parent_sprites_to_sort);
+	ViewportDrawCollectedSprites(_vd, vp);
+}
+
+/**
+ * State of the thread sorting the parent sprites of one viewport area while
+ * the sprites of the next area are being collected on the main thread.
+ * Collecting and drawing stay on the main thread as the sprite cache,
+ * NewGRF resolution and the blitters are not thread safe; the sorter only
+ * touches the sprites in #_vd_pending.
+ */
+struct ViewportSortThread {
+	ThreadObject *thread;       ///< The sort thread, or \c NULL when it is not running.
+	ThreadMutex *request_mutex; ///< Mutex guarding #requested and #exit; signalled by the main thread.
+	ThreadMutex *done_mutex;    ///< Mutex guarding #done; signalled by the sort thread.
+	bool requested;             ///< Whether #_vd_pending has to be sorted; cleared when the sort thread starts sorting.
+	bool done;                  ///< Whether #_vd_pending has been sorted; cleared when the main thread draws it.
+	bool exit;                  ///< Whether the sort thread has to stop.
+	bool failed;                ///< Whether starting the thread failed, so we do not retry every frame.
+};
+
+static ViewportSortThread _vp_sort_thread = { NULL, NULL, NULL, false, false, false, false };
+static ViewportDrawer _vd_pending;           ///< Area whose sprites are sorted by the sort thread.
+static const ViewPort *_vd_pending_vp = NULL; ///< Viewport of #_vd_pending, or \c NULL when nothing is pending.
+
+/**
+ * Main loop of the sort thread.
+ * Each direction of the handshake has its own mutex, so every signal has
+ * only one thread waiting for it and cannot be consumed by the other one.
+ */
+static void ViewportSortThreadProc(void *)
+{
+	for (;;) {
+		_vp_sort_thread.request_mutex->BeginCritical();
+		while (!_vp_sort_thread.requested && !_vp_sort_thread.exit) _vp_sort_thread.request_mutex->WaitForSignal();
+		bool requested = _vp_sort_thread.requested;
+		_vp_sort_thread.requested = false;
+		_vp_sort_thread.request_mutex->EndCritical();
+		if (!requested) break;
+
+		_vp_sprite_sorter(&_vd_pending.parent_sprites_to_sort);
+
+		_vp_sort_thread.done_mutex->BeginCritical();
+		_vp_sort_thread.done = true;
+		_vp_sort_thread.done_mutex->SendSignal();
+		_vp_sort_thread.done_mutex->EndCritical();
+	}
+}
+
+/**
+ * Get whether the parent sprites can be sorted on a separate thread,
+ * starting that thread when it is not running yet.
+ * @return True when the sort thread is available.
+ */
+static bool ViewportHasSortThread()
+{
+	if (_vp_sort_thread.thread != NULL) return true;
+	if (_vp_sort_thread.failed) return false;
+
+	if (GetCPUCoreCount() > 1) {
+		_vp_sort_thread.request_mutex = ThreadMutex::New();
+		_vp_sort_thread.done_mutex = ThreadMutex::New();
+		_vp_sort_thread.requested = false;
+		_vp_sort_thread.done = false;
+		_vp_sort_thread.exit = false;
+		if (ThreadObject::New(&ViewportSortThreadProc, NULL, &_vp_sort_thread.thread, "ottd:vp-sort")) return true;
+		delete _vp_sort_thread.request_mutex;
+		delete _vp_sort_thread.done_mutex;
+		_vp_sort_thread.request_mutex = NULL;
+		_vp_sort_thread.done_mutex = NULL;
+	}
+
+	_vp_sort_thread.failed = true;
+	return false;
+}
+
+/** Wait for the sort thread to finish the pending area and draw it. */
+static void ViewportDrawPending()
+{
+	if (_vd_pending_vp == NULL) return;
+
+	_vp_sort_thread.done_mutex->BeginCritical();
+	while (!_vp_sort_thread.done) _vp_sort_thread.done_mutex->WaitForSignal();
+	_vp_sort_thread.done = false;
+	_vp_sort_thread.done_mutex->EndCritical();
+
+	ViewportDrawCollectedSprites(_vd_pending, _vd_pending_vp);
+	_vd_pending_vp = NULL;
+}
+
+/** Stop the sort thread and free its resources, e.g. when shutting down. */
+void StopViewportSortThread()
+{
+	if (_vp_sort_thread.thread == NULL) return;
+
+	/* The area that is still being sorted will not be drawn anymore. */
+	_vd_pending_vp = NULL;
+
+	_vp_sort_thread.request_mutex->BeginCritical();
+	_vp_sort_thread.exit = true;
+	_vp_sort_thread.request_mutex->SendSignal();
+	_vp_sort_thread.request_mutex->EndCritical();
+
+	_vp_sort_thread.thread->Join();
+	delete _vp_sort_thread.thread;
+	delete _vp_sort_thread.request_mutex;
+	delete _vp_sort_thread.done_mutex;
+	_vp_sort_thread.thread = NULL;
+	_vp_sort_thread.request_mutex = NULL;
+	_vp_sort_thread.done_mutex = NULL;
+}
+
+/**
+ * Draw an area of a viewport, overlapping the sorting of its parent sprites
+ * with collecting the sprites of the next area when a sort thread is available.
+ * The area is only guaranteed to be drawn after #ViewportDrawPending.
+ * @param vp     The viewport to draw.
+ * @param left   Left edge of the area, in virtual viewport coordinates.
+ * @param top    Top edge of the area, in virtual viewport coordinates.
+ * @param right  Right edge of the area, in virtual viewport coordinates.
+ * @param bottom Bottom edge of the area, in virtual viewport coordinates.
+ */
+static void ViewportDoDrawPipelined(const ViewPort *vp, int left, int top, int right, int bottom)
+{
+	if (!ViewportHasSortThread()) {
+		ViewportDoDraw(vp, left, top, right, bottom);
+		return;
+	}
+
+	ViewportCollectSprites(vp, left, top, right, bottom);
+	ViewportDrawPending();
+
+	/* Hand the collected sprites to the sort thread; the lists are swapped
+	 * rather than copied so the pointers in parent_sprites_to_sort stay valid. */
+	_vd_pending.dpi = _vd.dpi;
+	_vd_pending.string_sprites_to_draw.Swap(_vd.string_sprites_to_draw);
+	_vd_pending.tile_sprites_to_draw.Swap(_vd.tile_sprites_to_draw);
+	_vd_pending.parent_sprites_to_draw.Swap(_vd.parent_sprites_to_draw);
+	_vd_pending.parent_sprites_to_sort.Swap(_vd.parent_sprites_to_sort);
+	_vd_pending.child_screen_sprites_to_draw.Swap(_vd.child_screen_sprites_to_draw);
+	_vd_pending_vp = vp;
+
+	_vp_sort_thread.request_mutex->BeginCritical();
+	_vp_sort_thread.requested = true;
+	_vp_sort_thread.request_mutex->SendSignal();
+	_vp_sort_thread.request_mutex->EndCritical();
 }
 
 /**
@@ -1624,7 +2416,7 @@ static void ViewportDrawChk(const ViewPort *vp, int left, int top, int right, in
 			ViewportDrawChk(vp, t, top, right, bottom);
 		}
 	} else {
-		ViewportDoDraw(vp,
+		ViewportDoDrawPipelined(vp,
 			ScaleByZoom(left - vp->left, vp->zoom) + vp->virtual_left,
 			ScaleByZoom(top - vp->top, vp->zoom) + vp->virtual_top,
 			ScaleByZoom(right - vp->left, vp->zoom) + vp->virtual_left,
@@ -1648,6 +2440,7 @@ static inline void ViewportDraw(const ViewPort *vp, int left, int top, int right
 	if (bottom > vp->top + vp->height) bottom = vp->top + vp->height;
 
 	ViewportDrawChk(vp, left, top, right, bottom);
+	ViewportDrawPending();
 }
 
 /**
@@ -1909,6 +2702,9 @@ void ConstrainAllViewportsZoom()
  */
 void MarkTileDirtyByTile(TileIndex tile, int bridge_level_offset)
 {
+	InvalidateCachedTilesAround(TileX(tile), TileY(tile));
+	MarkSmallMapTileDirty(tile);
+
 	Point pt = RemapCoords(TileX(tile) * TILE_SIZE, TileY(tile) * TILE_SIZE, TilePixelHeight(tile));
 	MarkAllViewportsDirty(
 			pt.x - MAX_TILE_EXTENT_LEFT,
@@ -1925,6 +2721,8 @@ void MarkTileDirtyByTile(TileIndex tile, int bridge_level_offset)
  */
 void MarkTileDirtyByTileOutsideMap(int x, int y)
 {
+	InvalidateCachedTilesAround(x, y);
+
 	Point pt = RemapCoords(x * TILE_SIZE, y * TILE_SIZE, TilePixelHeightOutsideMap(x, y));
 	MarkAllViewportsDirty(
 			pt.x - MAX_TILE_EXTENT_LEFT,
@@ -3239,6 +4037,7 @@ struct ViewportSSCSS {
 
 /** List of sorters ordered from best to worst. */
 static ViewportSSCSS _vp_sprite_sorters[] = {
+	{ &ViewportSortParentSpritesBucketedChecker, &ViewportSortParentSpritesBucketed },
 #ifdef WITH_SSE
 	{ &ViewportSortParentSpritesSSE41Checker, &ViewportSortParentSpritesSSE41 },
 #endif
@@ -3255,6 +4054,14 @@ void InitializeSpriteSorter()
 		}
 	}
 	assert(_vp_sprite_sorter != NULL);
+
+	/* Short lists are sorted quicker by comparing all pairs. */
+	for (uint i = 0; i < lengthof(_vp_sprite_sorters); i++) {
+		if (_vp_sprite_sorters[i].fct_sorter != &ViewportSortParentSpritesBucketed && _vp_sprite_sorters[i].fct_checker()) {
+			_vp_small_sprite_sorter = _vp_sprite_sorters[i].fct_sorter;
+			break;
+		}
+	}
 }
 
 /**
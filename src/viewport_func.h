@@ -81,6 +81,8 @@ extern Point _tile_fract_coords;
 void MarkTileDirtyByTile(TileIndex tile, int bridge_level_offset = 0);
 
 void MarkTileDirtyByTileOutsideMap(int x, int y);
+void ClearViewportTileCache();
+void StopViewportSortThread();
 
 Point GetViewportStationMiddle(const ViewPort *vp, const Station *st);
 
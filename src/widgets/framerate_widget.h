@@ -19,6 +19,7 @@ enum FramerateWindowWidgets {
 	WID_FRW_RATE_DRAWING,
 	WID_FRW_RATE_FACTOR,
 	WID_FRW_INFO_DATA_POINTS,
+	WID_FRW_INFO_SPRITE_CACHE,
 	WID_FRW_TIMES_NAMES,
 	WID_FRW_TIMES_CURRENT,
 	WID_FRW_TIMES_AVERAGE,
@@ -42,4 +42,13 @@ enum SpriteAlignerWidgets {
 	WID_SA_RESET_REL,   ///< Reset relative sprite offset
 };
 
+/** Widgets of the #NewGRFProfileWindow class. */
+enum NewGRFProfileWidgets {
+	WID_NGRFP_START,     ///< Start or stop profiling.
+	WID_NGRFP_RESET,     ///< Remove the collected data.
+	WID_NGRFP_SUMMARY,   ///< Profiled ticks and total time.
+	WID_NGRFP_LIST,      ///< Cost per NewGRF, feature and callback.
+	WID_NGRFP_SCROLLBAR, ///< Scrollbar.
+};
+
 #endif /* WIDGETS_NEWGRF_DEBUG_WIDGET_H */
@@ -693,6 +693,12 @@ enum WindowClass {
 	 */
 	WC_FRAMETIME_GRAPH,
 
+	/**
+	 * NewGRF profile (debug); %Window numbers:
+	 *   - 0 = #NewGRFProfileWidgets
+	 */
+	WC_NEWGRF_PROFILE,
+
 	WC_INVALID = 0xFFFF, ///< Invalid window.
 };
 